@@ -0,0 +1,174 @@
+// Runs a pipeline, which unpacks a video frame, downloads the first texture and
+// continues after a delay, with the coroutine adapters of rxext_coroutine.h and
+// with nested callbacks against the headless host. Verifies the downloaded data
+// and fails when the coroutine frames are not recycled by the CoroutineFramePool,
+// also when the host destroys a callback on shutdown without calling it.
+
+#include "Benchmark.h"
+#include "rxext_coroutine.h"
+#include "Host.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+using namespace rxext;
+
+namespace {
+  const size_t pipelines_in_flight = 16;
+  const size_t steady_state_pipelines = 1000;
+
+  // counts the completed pipelines and the ones, which received unexpected data
+  class Completion {
+  public:
+    void start(size_t count) {
+      auto lock = std::lock_guard(m_mutex);
+      m_remaining += count;
+    }
+
+    void complete(bool succeeded) noexcept {
+      auto lock = std::lock_guard(m_mutex);
+      m_failures += (succeeded ? 0 : 1);
+      if (!--m_remaining)
+        m_completed.notify_all();
+    }
+
+    void wait() {
+      auto lock = std::unique_lock(m_mutex);
+      m_completed.wait(lock, [&]() { return !m_remaining; });
+    }
+
+    size_t failures() const {
+      auto lock = std::lock_guard(m_mutex);
+      return m_failures;
+    }
+
+  private:
+    mutable std::mutex m_mutex;
+    std::condition_variable m_completed;
+    size_t m_remaining{ };
+    size_t m_failures{ };
+  };
+
+  class Frame {
+  public:
+    Frame(size_t width, size_t height, uint8_t value)
+      : m_data(width * height * 4, value) {
+      m_frame.resolution_x = width;
+      m_frame.resolution_y = height;
+      m_frame.pixel_format = "RGBA";
+      m_frame.planes.push_back({ m_data.data(), m_data.size(), width * 4 });
+    }
+
+    const VideoFrame& video_frame() const { return m_frame; }
+
+    bool matches(const BufferDesc& data) const {
+      return (data.size == m_data.size() &&
+        !std::memcmp(data.data, m_data.data(), m_data.size()));
+    }
+
+  private:
+    std::vector<uint8_t> m_data;
+    VideoFrame m_frame{ };
+  };
+
+  Task run_coroutine_pipeline(HostContext host, const Frame* frame, Completion* completion) {
+    auto textures = co_await unpack(host, frame->video_frame());
+    auto succeeded = (textures.size() == 1);
+    if (succeeded) {
+      const auto data = co_await download(host, std::move(textures[0]));
+      succeeded = frame->matches(data);
+    }
+    co_await delay(host, std::chrono::duration<double>::zero());
+    completion->complete(succeeded);
+  }
+
+  void run_callback_pipeline(HostContext host, const Frame* frame, Completion* completion) {
+    host.unpack_video_frame(frame->video_frame(),
+      [host, frame, completion](vector<TextureRef> textures) mutable noexcept {
+        if (textures.size() != 1)
+          return completion->complete(false);
+        host.download_texture(std::move(textures[0]),
+          [host, frame, completion](BufferDesc data) mutable noexcept {
+            const auto succeeded = frame->matches(data);
+            host.set_timeout(std::chrono::duration<double>::zero(),
+              [completion, succeeded]() noexcept { completion->complete(succeeded); });
+          });
+      });
+  }
+
+  // counts the coroutines, which were destroyed or continued after their timeout
+  struct Abandoned {
+    std::atomic<size_t> destroyed{ };
+    std::atomic<size_t> continued{ };
+  };
+
+  Task run_abandoned_coroutine(HostContext host, Abandoned* abandoned) {
+    auto guard = std::unique_ptr<Abandoned, void(*)(Abandoned*)>(abandoned,
+      [](Abandoned* abandoned) { ++abandoned->destroyed; });
+    co_await delay(host, std::chrono::hours(1));
+    ++abandoned->continued;
+  }
+
+  template<typename F>
+  void run_pipelines(F&& run_pipeline, HostContext host, const Frame& frame,
+      Completion& completion, size_t count) {
+    completion.start(count);
+    for (auto i = size_t{ }; i < count; ++i)
+      run_pipeline(host, &frame, &completion);
+    completion.wait();
+  }
+} // namespace
+
+int main(int argc, char* argv[]) {
+  if (!bench::parse_arguments(argc, argv))
+    return EXIT_FAILURE;
+
+  auto host_context = headless::Host({ });
+  const auto host = HostContext(&host_context);
+  const auto frame = Frame(256, 64, 0x5A);
+  auto completion = Completion();
+
+  bench::print_header("unpack, download and delay");
+  bench::print_result("callbacks", bench::measure(pipelines_in_flight, [&]() {
+    run_pipelines(run_callback_pipeline, host, frame, completion, pipelines_in_flight);
+  }));
+  bench::print_result("coroutine", bench::measure(pipelines_in_flight, [&]() {
+    run_pipelines(run_coroutine_pipeline, host, frame, completion, pipelines_in_flight);
+  }));
+
+  auto& pool = CoroutineFramePool::instance();
+  const auto filled = pool.stats();
+  for (auto i = size_t{ }; i < steady_state_pipelines; i += pipelines_in_flight)
+    run_pipelines(run_coroutine_pipeline, host, frame, completion, pipelines_in_flight);
+
+  const auto allocations = pool.stats().frames_allocated - filled.frames_allocated;
+
+  // the timeouts are destroyed without being called on shutdown
+  auto abandoned = Abandoned();
+  for (auto i = size_t{ }; i < pipelines_in_flight; ++i)
+    run_abandoned_coroutine(host, &abandoned);
+
+  // a frame is freed after its pipeline completed, stopping the workers waits for it
+  host_context.shutdown();
+  const auto stats = pool.stats();
+  std::printf("coroutine frames: %llu allocated, %llu reused, %zu free\n",
+    static_cast<unsigned long long>(stats.frames_allocated),
+    static_cast<unsigned long long>(stats.frames_reused), stats.frames_free);
+
+  if (completion.failures()) {
+    std::fprintf(stderr, "%zu pipelines received unexpected data\n", completion.failures());
+    return EXIT_FAILURE;
+  }
+  if (abandoned.destroyed != pipelines_in_flight || abandoned.continued) {
+    std::fprintf(stderr, "coroutines were not destroyed with their callbacks\n");
+    return EXIT_FAILURE;
+  }
+  if (stats.frames_free != stats.frames_allocated || allocations >= pipelines_in_flight) {
+    std::fprintf(stderr, "CoroutineFramePool did not recycle the frames\n");
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
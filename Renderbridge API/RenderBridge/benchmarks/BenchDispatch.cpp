@@ -0,0 +1,409 @@
+
+// Measures the per-frame cost of calling streams through the function tables
+// of rxext.h, which dispatch through the thunks of rxext_client.h to the
+// virtual functions of the client classes.
+
+#include "Benchmark.h"
+#include "Host.h"
+#include "rxext_client.h"
+#include <memory>
+#include <string>
+
+using namespace rxext;
+
+namespace {
+  const size_t stream_counts[] = { 1, 4, 16, 64, 256 };
+  const size_t parameter_counts[] = { 1, 16, 64, 256 };
+  const size_t default_stream_count = 16;
+
+  class Input : public InputStream {
+  public:
+    explicit Input(const ValueSet& settings)
+        : m_sampler(*add_output_parameter<ParameterTexture>(ParameterNames::sampler)) {
+      const auto parameter_count = settings.get<size_t>("parameter_count");
+      for (auto i = size_t{ }; i < parameter_count; ++i) {
+        auto parameter = add_parameter<ParameterValue>("value" + std::to_string(i));
+        parameter->set_property(PropertyNames::group_name, "values");
+        parameter->set_property(PropertyNames::name, "Value " + std::to_string(i));
+      }
+      if (settings.get<bool>("track_state"))
+        invalidate_state();
+    }
+
+    bool initialize() noexcept override {
+      m_sampler.set_texture(host().create_texture({ 1, 1, Format::R8G8B8A8_UNORM }));
+      return true;
+    }
+
+    string get_property(string_view name) noexcept override {
+      if (name == PropertyNames::name)
+        return string("Input");
+      return { };
+    }
+
+    ValueSet get_state() noexcept override {
+      auto state = ValueSet();
+      state.set(StateNames::resolution_x, 1920);
+      state.set(StateNames::resolution_y, 1080);
+      state.set(StateNames::frame_rate, 60.0);
+      state.set(StateNames::pixel_format, "RGBA");
+      return state;
+    }
+
+    bool update() noexcept override { ++m_frame_index; return true; }
+    RenderResult render() noexcept override { ++m_frame_index; return RenderResult::Succeeded; }
+
+  private:
+    ParameterTexture& m_sampler;
+    size_t m_frame_index{ };
+  };
+
+  class Output : public OutputStream {
+  public:
+    bool initialize() noexcept override {
+      m_target = host().create_texture({ 1, 1, Format::B8G8R8A8_UNORM, true });
+      return true;
+    }
+    TextureRef get_target() noexcept override { return m_target; }
+    void present() noexcept override { ++m_frame_index; }
+
+  private:
+    TextureRef m_target;
+    size_t m_frame_index{ };
+  };
+
+  class Device : public StreamDevice {
+  public:
+    InputStream* create_input_stream(ValueSet settings) noexcept override {
+      return new Input(settings);
+    }
+    OutputStream* create_output_stream(ValueSet settings) noexcept override {
+      return new Output();
+    }
+    bool update() noexcept override { ++m_frame_index; return true; }
+
+  private:
+    size_t m_frame_index{ };
+  };
+
+  vector<ValueSet> create_sources(size_t source_count, size_t renamed_source = ~size_t{ }) {
+    auto sources = vector<ValueSet>();
+    for (auto i = size_t{ }; i < source_count; ++i) {
+      auto& source = sources.emplace_back();
+      const auto name = "HOST-" + std::to_string(i) + " (Source " + std::to_string(i) + ")";
+      source.set(SettingNames::name, (i == renamed_source ? name + " renamed" : name));
+      source.set(SettingNames::handle, "Source " + std::to_string(i));
+    }
+    return sources;
+  }
+
+  // reports discovered sources like the NDI device
+  class DiscoveryDevice : public StreamDevice {
+  public:
+    void update_sources(vector<ValueSet> sources) { m_sources.update(std::move(sources)); }
+    uint64_t token() const { return m_sources.token(); }
+    vector<ValueSet> enumerate_stream_settings() noexcept override { return m_sources.settings(); }
+    StreamSettingsDelta enumerate_stream_settings_delta(uint64_t token) noexcept override {
+      return m_sources.get_delta(token);
+    }
+
+  private:
+    StreamSettingsTracker m_sources;
+  };
+
+  // owns a device with a number of streams, which are only accessed through the function tables
+  class Setup {
+  public:
+    Setup(headless::Host& host, size_t input_count, size_t output_count, 
+        size_t parameter_count, bool track_state = false, bool monitor_phases = false)
+        : m_device(new Device()) {
+      m_device->initialize(m_device, &host);
+      auto settings = ValueSet();
+      settings.set("parameter_count", parameter_count);
+      settings.set("track_state", track_state);
+      for (auto i = size_t{ }; i < input_count; ++i) {
+        if (monitor_phases)
+          settings.set(SettingNames::monitor_id, "in" + std::to_string(i));
+        auto input = m_device->create_input_stream(m_device, settings);
+        input->initialize(input, &host);
+        m_inputs.push_back(input);
+      }
+      for (auto i = size_t{ }; i < output_count; ++i) {
+        if (monitor_phases)
+          settings.set(SettingNames::monitor_id, "out" + std::to_string(i));
+        auto output = m_device->create_output_stream(m_device, settings);
+        output->initialize(output, &host);
+        m_outputs.push_back(output);
+      }
+      m_device->set_active_streams(m_device, m_inputs.data(), m_inputs.size(),
+        m_outputs.data(), m_outputs.size());
+    }
+    Setup(const Setup&) = delete;
+    Setup& operator=(const Setup&) = delete;
+    ~Setup() {
+      for (auto input : m_inputs)
+        input->release(input);
+      for (auto output : m_outputs)
+        output->release(output);
+      m_device->release(m_device);
+    }
+
+    StreamDeviceP* device() const { return m_device; }
+    const std::vector<InputStreamP*>& inputs() const { return m_inputs; }
+    const std::vector<OutputStreamP*>& outputs() const { return m_outputs; }
+
+  private:
+    StreamDeviceP* m_device;
+    std::vector<InputStreamP*> m_inputs;
+    std::vector<OutputStreamP*> m_outputs;
+  };
+
+  std::string format_case(const char* name, size_t streams, size_t parameters = 0) {
+    auto result = std::string(name) + " streams=" + std::to_string(streams);
+    if (parameters)
+      result += " params=" + std::to_string(parameters);
+    return result;
+  }
+
+  void benchmark_frame(headless::Host& host) {
+    bench::print_header("per-frame call sequence");
+    for (auto stream_count : stream_counts) {
+      const auto setup = Setup(host, stream_count, stream_count, 0);
+      const auto timed = Setup(host, stream_count, stream_count, 0, false, true);
+
+      bench::print_result(format_case("device frame", stream_count),
+        bench::measure(4, [&]() {
+          auto device = setup.device();
+          device->update(device);
+          bench::do_not_optimize(device->before_render(device));
+          device->render(device);
+          bench::do_not_optimize(device->after_render(device));
+        }));
+
+      bench::print_result(format_case("input frame", stream_count),
+        bench::measure(4 * stream_count, [&]() {
+          for (auto input : setup.inputs()) {
+            input->update(input);
+            bench::do_not_optimize(input->before_render(input));
+            bench::do_not_optimize(input->render(input));
+            bench::do_not_optimize(input->after_render(input));
+          }
+        }));
+
+      bench::print_result(format_case("input frame phase timers", stream_count),
+        bench::measure(4 * stream_count, [&]() {
+          for (auto input : timed.inputs()) {
+            input->update(input);
+            bench::do_not_optimize(input->before_render(input));
+            bench::do_not_optimize(input->render(input));
+            bench::do_not_optimize(input->after_render(input));
+          }
+        }));
+
+      bench::print_result(format_case("input sampler get_value", stream_count),
+        bench::measure(stream_count, [&]() {
+          for (auto input : setup.inputs()) {
+            auto sampler = input->get_parameter(input, 0);
+            auto texture = static_cast<TextureP*>(nullptr);
+            auto size = sizeof(texture);
+            sampler->get_value(sampler, &texture, &size);
+            texture->release(texture);
+          }
+        }));
+
+      bench::print_result(format_case("output frame", stream_count),
+        bench::measure(5 * stream_count, [&]() {
+          for (auto output : setup.outputs()) {
+            auto target = output->get_target(output);
+            bench::do_not_optimize(output->before_render(output));
+            bench::do_not_optimize(output->after_render(output));
+            output->present(output);
+            target->release(target);
+          }
+          for (auto output : setup.outputs())
+            output->swap(output);
+        }));
+    }
+  }
+
+  void benchmark_parameters(headless::Host& host) {
+    bench::print_header("parameter values");
+    for (auto parameter_count : parameter_counts) {
+      const auto stream_count = default_stream_count;
+      const auto setup = Setup(host, stream_count, 0, parameter_count);
+      const auto calls = stream_count * parameter_count;
+      auto value = 0.0;
+
+      bench::print_result(format_case("set_value", stream_count, parameter_count),
+        bench::measure(calls, [&]() {
+          value += 1.0;
+          for (auto input : setup.inputs())
+            for (auto i = size_t{ 1 }; i <= parameter_count; ++i) {
+              auto parameter = input->get_parameter(input, i);
+              parameter->set_value(parameter, &value, sizeof(value));
+            }
+        }));
+
+      auto updates = std::vector<ParameterValueUpdate>();
+      for (auto i = size_t{ 1 }; i <= parameter_count; ++i)
+        updates.push_back({ i, &value, sizeof(value) });
+      bench::print_result(format_case("set_parameter_values", stream_count, parameter_count),
+        bench::measure(calls, [&]() {
+          value += 1.0;
+          for (auto input : setup.inputs())
+            input->set_parameter_values(input, updates.data(), updates.size());
+        }));
+
+      bench::print_result(format_case("get_value", stream_count, parameter_count),
+        bench::measure(calls, [&]() {
+          for (auto input : setup.inputs())
+            for (auto i = size_t{ 1 }; i <= parameter_count; ++i) {
+              auto parameter = input->get_parameter(input, i);
+              auto size = sizeof(value);
+              parameter->get_value(parameter, &value, &size);
+              bench::do_not_optimize(value);
+            }
+        }));
+
+      bench::print_result(format_case("get_property", stream_count, parameter_count),
+        bench::measure(calls, [&]() {
+          for (auto input : setup.inputs())
+            for (auto i = size_t{ 1 }; i <= parameter_count; ++i) {
+              auto parameter = input->get_parameter(input, i);
+              bench::do_not_optimize(parameter->get_property(parameter,
+                PropertyNames::group_name).size());
+            }
+        }));
+    }
+  }
+
+  void benchmark_registration() {
+    bench::print_header("parameter registration");
+    for (auto parameter_count : parameter_counts) {
+      auto settings = ValueSet();
+      settings.set("parameter_count", parameter_count);
+      bench::print_result(format_case("create input", 1, parameter_count),
+        bench::measure(parameter_count, [&]() {
+          bench::do_not_optimize(std::make_unique<Input>(settings));
+        }));
+    }
+  }
+
+  void benchmark_lookup(headless::Host& host) {
+    bench::print_header("parameter lookup");
+    for (auto parameter_count : parameter_counts) {
+      const auto setup = Setup(host, 1, 0, parameter_count);
+      auto& input = *InputStream::cast(setup.inputs().front());
+      const auto name = "value" + std::to_string(parameter_count - 1);
+      const auto friendly_name = "Value " + std::to_string(parameter_count - 1);
+
+      bench::print_result(format_case("find_parameter name", 1, parameter_count),
+        bench::measure(1, [&]() {
+          bench::do_not_optimize(input.find_parameter(name));
+        }));
+
+      bench::print_result(format_case("find_parameter property", 1, parameter_count),
+        bench::measure(1, [&]() {
+          bench::do_not_optimize(input.find_parameter(PropertyNames::name, friendly_name));
+        }));
+
+      // property index is rebuilt after each change
+      auto parameter = input.find_parameter(name);
+      bench::print_result(format_case("find_parameter changed", 1, parameter_count),
+        bench::measure(1, [&]() {
+          parameter->set_property(PropertyNames::name, friendly_name);
+          bench::do_not_optimize(input.find_parameter(PropertyNames::name, friendly_name));
+        }));
+    }
+  }
+
+  void benchmark_state(headless::Host& host) {
+    bench::print_header("state queries");
+    for (auto stream_count : stream_counts) {
+      const auto setup = Setup(host, stream_count, 0, 16);
+
+      bench::print_result(format_case("get_state", stream_count),
+        bench::measure(stream_count, [&]() {
+          for (auto input : setup.inputs())
+            bench::do_not_optimize(input->get_state(input).values.size());
+        }));
+
+      const auto tracking = Setup(host, stream_count, 0, 16, true);
+      bench::print_result(format_case("get_state cached", stream_count),
+        bench::measure(stream_count, [&]() {
+          for (auto input : tracking.inputs())
+            bench::do_not_optimize(input->get_state(input).values.size());
+        }));
+
+      auto generations = std::vector<uint64_t>(stream_count);
+      auto state = ValueSet();
+      bench::print_result(format_case("get_state_if_changed unchanged", stream_count),
+        bench::measure(stream_count, [&]() {
+          for (auto i = size_t{ }; i < stream_count; ++i) {
+            auto input = tracking.inputs()[i];
+            bench::do_not_optimize(input->get_state_if_changed(input, &generations[i], &state));
+          }
+        }));
+
+      bench::print_result(format_case("get_property", stream_count),
+        bench::measure(stream_count, [&]() {
+          for (auto input : setup.inputs())
+            bench::do_not_optimize(input->get_property(input, PropertyNames::name).size());
+        }));
+
+      bench::print_result(format_case("enumerate parameters", stream_count),
+        bench::measure(stream_count, [&]() {
+          for (auto input : setup.inputs()) {
+            const auto count = input->get_parameter_count(input);
+            for (auto i = size_t{ }; i < count; ++i)
+              bench::do_not_optimize(input->get_parameter(input, i));
+          }
+        }));
+    }
+  }
+
+  void benchmark_enumeration() {
+    bench::print_header("stream enumeration");
+    for (auto source_count : { size_t{ 16 }, size_t{ 256 } }) {
+      auto device = DiscoveryDevice();
+      const auto sources = create_sources(source_count);
+      const auto renamed = create_sources(source_count, source_count / 2);
+      device.update_sources(sources);
+      StreamDeviceP* p = &device;
+
+      bench::print_result(format_case("enumerate_stream_settings", source_count),
+        bench::measure(1, [&]() {
+          bench::do_not_optimize(p->enumerate_stream_settings(p).size());
+        }));
+
+      const auto token = device.token();
+      bench::print_result(format_case("enumerate_stream_settings_delta unchanged", source_count),
+        bench::measure(1, [&]() {
+          bench::do_not_optimize(p->enumerate_stream_settings_delta(p, token).token);
+        }));
+
+      // one source is renamed on every call, the host holds the previous token
+      auto flip = false;
+      bench::print_result(format_case("tracker update, delta of 1 change", source_count),
+        bench::measure(1, [&]() {
+          const auto previous = device.token();
+          device.update_sources((flip = !flip) ? renamed : sources);
+          bench::do_not_optimize(p->enumerate_stream_settings_delta(p, previous).changed.size());
+        }));
+    }
+  }
+} // namespace
+
+int main(int argc, char* argv[]) {
+  if (!bench::parse_arguments(argc, argv))
+    return EXIT_FAILURE;
+
+  auto host = headless::Host({ });
+  benchmark_frame(host);
+  benchmark_parameters(host);
+  benchmark_registration();
+  benchmark_lookup(host);
+  benchmark_state(host);
+  benchmark_enumeration();
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,208 @@
+
+// Compares producing video frames in buffers, which are allocated per frame
+// and freed in the OnComplete callback, with buffers recycled by a FramePool.
+// Counts the heap allocations per frame once the pipeline is filled and
+// fails when the FramePool still allocates.
+
+#include "Benchmark.h"
+#include "rxext_client.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string>
+
+using namespace rxext;
+
+namespace {
+  std::atomic<size_t> g_allocations{ };
+} // namespace
+
+void* operator new(size_t size) {
+  g_allocations.fetch_add(1, std::memory_order_relaxed);
+  if (auto memory = std::malloc(size ? size : 1))
+    return memory;
+  throw std::bad_alloc();
+}
+
+void* operator new(size_t size, std::align_val_t alignment) {
+  g_allocations.fetch_add(1, std::memory_order_relaxed);
+  const auto align = static_cast<size_t>(alignment);
+#if defined(_MSC_VER)
+  if (auto memory = _aligned_malloc(size ? size : 1, align))
+#else
+  if (auto memory = std::aligned_alloc(align, (std::max(size, size_t{ 1 }) + align - 1) / align * align))
+#endif
+    return memory;
+  throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, size_t) noexcept { std::free(memory); }
+
+void operator delete(void* memory, std::align_val_t) noexcept {
+#if defined(_MSC_VER)
+  _aligned_free(memory);
+#else
+  std::free(memory);
+#endif
+}
+
+void operator delete(void* memory, size_t, std::align_val_t alignment) noexcept {
+  operator delete(memory, alignment);
+}
+
+namespace {
+  // number of frames the host keeps before calling OnComplete
+  const size_t frames_in_flight = 3;
+  const size_t steady_state_frames = 1000;
+
+  struct FrameFormat {
+    const char* name;
+    size_t width;
+    size_t height;
+    std::array<FramePool::PlaneSize, 3> planes;
+    size_t plane_count;
+  };
+
+  FrameFormat rgba(const char* name, size_t width, size_t height) {
+    return { name, width, height, { { { width * 4, height } } }, 1 };
+  }
+
+  FrameFormat i420(const char* name, size_t width, size_t height) {
+    return { name, width, height, { { { width, height },
+      { width / 2, height / 2 }, { width / 2, height / 2 } } }, 3 };
+  }
+
+  // simulates a host, which completes frames after others were sent
+  class Host {
+  public:
+    void send_video_frame(const VideoFrame& frame, OnComplete on_complete) {
+      bench::do_not_optimize(frame.planes[0].data);
+      auto& slot = m_in_flight[m_index++ % m_in_flight.size()];
+      if (slot)
+        slot();
+      slot = std::move(on_complete);
+    }
+
+    void flush() {
+      for (auto& slot : m_in_flight)
+        if (slot)
+          std::exchange(slot, { })();
+    }
+
+  private:
+    std::array<OnComplete, frames_in_flight> m_in_flight;
+    size_t m_index{ };
+  };
+
+  class AllocatingProducer {
+  public:
+    explicit AllocatingProducer(const FrameFormat& format) : m_format(format) {
+      m_frame.planes.reserve(format.plane_count);
+    }
+
+    void write_video_frame(Host& host, uint8_t value) {
+      m_frame.planes.clear();
+      auto data = std::make_unique<std::unique_ptr<uint8_t[]>[]>(m_format.plane_count);
+      for (auto i = size_t{ }; i < m_format.plane_count; ++i) {
+        const auto& plane = m_format.planes[i];
+        const auto size = plane.row_size * plane.rows;
+        data[i] = std::unique_ptr<uint8_t[]>(new uint8_t[size]);
+        std::memset(data[i].get(), value, size);
+        m_frame.planes.push_back({ data[i].get(), size, plane.row_size });
+      }
+      host.send_video_frame(m_frame, [data = std::move(data)]() noexcept { });
+    }
+
+  private:
+    const FrameFormat& m_format;
+    VideoFrame m_frame{ };
+  };
+
+  class PoolProducer {
+  public:
+    explicit PoolProducer(const FrameFormat& format) : m_format(format) {
+      m_frame.planes.reserve(format.plane_count);
+    }
+
+    void write_video_frame(Host& host, uint8_t value) {
+      m_frame.planes.clear();
+      auto buffers = (m_format.plane_count == 1 ?
+        m_pool.acquire({ m_format.planes[0] }) :
+        m_pool.acquire({ m_format.planes[0], m_format.planes[1], m_format.planes[2] }));
+      for (auto i = size_t{ }; i < m_format.plane_count; ++i) {
+        const auto plane = buffers.plane(i);
+        std::memset(buffers.data(i), value, plane.size);
+        m_frame.planes.push_back(plane);
+      }
+      host.send_video_frame(m_frame, buffers.release_on_complete());
+    }
+
+    const FramePool& pool() const { return m_pool; }
+
+  private:
+    const FrameFormat& m_format;
+    FramePool m_pool;
+    VideoFrame m_frame{ };
+  };
+
+  template<typename Producer>
+  double allocations_per_frame(Producer& producer, Host& host) {
+    auto value = uint8_t{ };
+    for (auto i = size_t{ }; i < frames_in_flight * 2; ++i)
+      producer.write_video_frame(host, ++value);
+    const auto allocations = g_allocations.load();
+    for (auto i = size_t{ }; i < steady_state_frames; ++i)
+      producer.write_video_frame(host, ++value);
+    return static_cast<double>(g_allocations.load() - allocations) / steady_state_frames;
+  }
+
+  template<typename Producer>
+  double benchmark_producer(const char* name, const FrameFormat& format, Producer& producer) {
+    auto host = Host();
+    auto value = uint8_t{ };
+    bench::print_result(std::string(name) + " " + format.name,
+      bench::measure(1, [&]() {
+        producer.write_video_frame(host, ++value);
+      }));
+    const auto allocations = allocations_per_frame(producer, host);
+    host.flush();
+    return allocations;
+  }
+} // namespace
+
+int main(int argc, char* argv[]) {
+  if (!bench::parse_arguments(argc, argv))
+    return EXIT_FAILURE;
+
+  const FrameFormat formats[] = {
+    rgba("RGBA 1920x1080", 1920, 1080),
+    rgba("RGBA 3840x2160", 3840, 2160),
+    i420("I420 3840x2160", 3840, 2160),
+  };
+
+  auto pool_allocations = 0.0;
+  for (const auto& format : formats) {
+    bench::print_header(format.name);
+    auto allocating = AllocatingProducer(format);
+    const auto allocating_allocations = benchmark_producer("allocate per frame", format, allocating);
+    auto pooled = PoolProducer(format);
+    const auto pooled_allocations = benchmark_producer("FramePool", format, pooled);
+    pool_allocations += pooled_allocations;
+
+    const auto stats = pooled.pool().stats();
+    std::printf("allocations/frame: allocate per frame %.2f, FramePool %.2f (%llu buffers allocated, %zu alive)\n",
+      allocating_allocations, pooled_allocations,
+      static_cast<unsigned long long>(stats.buffers_allocated), stats.buffers_alive);
+  }
+
+  if (pool_allocations > 0) {
+    std::fprintf(stderr, "FramePool allocated in steady state\n");
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
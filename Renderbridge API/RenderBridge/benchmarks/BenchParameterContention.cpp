@@ -0,0 +1,103 @@
+
+// Measures reading and writing ParameterT values while other threads access
+// the same parameter concurrently, comparing the mutex guarded storage with
+// the lock-free sequence lock storage.
+
+#include "Benchmark.h"
+#include "rxext_client.h"
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace rxext;
+
+namespace {
+  const size_t background_thread_counts[] = { 0, 1, 3 };
+
+  template<typename T, ParameterType Type>
+  using MutexParameter = ParameterT<T, Type, MutexStorage<T>>;
+
+  template<typename T, ParameterType Type>
+  using SeqLockParameter = ParameterT<T, Type, SeqLockStorage<T>>;
+
+  // runs function on a number of threads until destroyed
+  class BackgroundThreads {
+  public:
+    template<typename F>
+    BackgroundThreads(size_t count, F function) {
+      for (auto i = size_t{ }; i < count; ++i)
+        m_threads.emplace_back([this, function]() {
+          while (!m_stop.load(std::memory_order_relaxed))
+            function();
+        });
+    }
+    BackgroundThreads(const BackgroundThreads&) = delete;
+    BackgroundThreads& operator=(const BackgroundThreads&) = delete;
+    ~BackgroundThreads() {
+      m_stop.store(true);
+      for (auto& thread : m_threads)
+        thread.join();
+    }
+
+  private:
+    std::atomic<bool> m_stop{ };
+    std::vector<std::thread> m_threads;
+  };
+
+  std::string format_case(const char* storage, const char* type,
+      const char* operation, size_t threads, const char* others) {
+    return std::string(storage) + " " + type + " " + operation +
+      " +" + std::to_string(threads) + " " + others;
+  }
+
+  template<typename Parameter>
+  void benchmark_parameter(const char* storage, const char* type) {
+    using T = decltype(std::declval<Parameter>().value());
+    auto parameter = Parameter("value");
+    auto written = T{ };
+
+    // render thread reading while host threads write
+    for (auto writers : background_thread_counts) {
+      const auto threads = BackgroundThreads(writers, [&parameter]() {
+        static thread_local auto value = T{ };
+        reinterpret_cast<unsigned char&>(value) += 1;
+        parameter.set_value(value);
+      });
+      bench::print_result(format_case(storage, type, "read", writers, "writers"),
+        bench::measure(1, [&]() {
+          bench::do_not_optimize(parameter.value());
+        }));
+    }
+
+    // host thread writing while render threads read
+    for (auto readers : background_thread_counts) {
+      const auto threads = BackgroundThreads(readers, [&parameter]() {
+        bench::do_not_optimize(parameter.value());
+      });
+      bench::print_result(format_case(storage, type, "write", readers, "readers"),
+        bench::measure(1, [&]() {
+          reinterpret_cast<unsigned char&>(written) += 1;
+          parameter.set_value(written);
+        }));
+    }
+  }
+
+  template<template<typename, ParameterType> typename Parameter>
+  void benchmark_storage(const char* storage) {
+    bench::print_header(std::string(storage) + " storage");
+    benchmark_parameter<Parameter<double, ParameterType::Value>>(storage, "Value");
+    benchmark_parameter<Parameter<std::array<double, 4>, ParameterType::Vector4>>(storage, "Vector4");
+    benchmark_parameter<Parameter<std::array<double, 16>, ParameterType::Matrix4>>(storage, "Matrix4");
+  }
+} // namespace
+
+int main(int argc, char* argv[]) {
+  if (!bench::parse_arguments(argc, argv))
+    return EXIT_FAILURE;
+
+  std::printf("hardware threads: %u\n", std::thread::hardware_concurrency());
+  benchmark_storage<MutexParameter>("mutex");
+  benchmark_storage<SeqLockParameter>("seqlock");
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,103 @@
+
+// Verifies that the sliding window minimum and maximum of a WindowedStatistic
+// match a scan of the window's samples and that pushing batches results in the
+// same statistics as pushing single values, then compares pushing a frame
+// duration and querying its minimum and maximum with scanning the samples.
+
+#include "Benchmark.h"
+#include "common/statistics.h"
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace common;
+
+namespace {
+  const size_t batch_size = 64;
+
+  std::vector<double> create_durations(size_t count) {
+    auto random = std::mt19937_64(1);
+    auto jitter = std::normal_distribution<double>(0.0, 0.0005);
+    auto values = std::vector<double>(count);
+    for (auto& value : values)
+      value = 1.0 / 60 + jitter(random);
+    return values;
+  }
+
+  bool close(double a, double b) {
+    return std::fabs(a - b) <= 1e-6 * (std::fabs(a) + std::fabs(b)) + 1e-12;
+  }
+
+  template<size_t Capacity>
+  size_t verify(size_t capacity, const std::vector<double>& values) {
+    auto single = WindowedStatistic<double, Capacity>(capacity);
+    auto batched = WindowedStatistic<double, Capacity>(capacity);
+    auto window = std::deque<double>();
+    auto failures = size_t{ };
+    for (auto i = size_t{ }; i + batch_size <= values.size(); i += batch_size) {
+      for (auto j = i; j < i + batch_size; ++j) {
+        single.push(values[j]);
+        window.push_back(values[j]);
+        if (window.size() > capacity)
+          window.pop_front();
+        failures += (single.min() != *std::min_element(window.begin(), window.end()));
+        failures += (single.max() != *std::max_element(window.begin(), window.end()));
+      }
+      batched.push(values.data() + i, batch_size);
+      failures += (batched.min() != single.min() || batched.max() != single.max());
+      failures += !close(batched.mean(), single.mean());
+      failures += !close(batched.variance(), single.variance());
+    }
+    if (failures)
+      std::fprintf(stderr, "%zu mismatches with window of %zu samples\n", failures, capacity);
+    return failures;
+  }
+
+  template<size_t Capacity>
+  void benchmark_window(const std::string& name, size_t capacity, const std::vector<double>& values) {
+    auto statistic = WindowedStatistic<double, Capacity>(capacity);
+    auto samples = SampleCache<double>(capacity);
+    auto index = size_t{ };
+
+    bench::print_result("push and scan min/max " + name, bench::measure(1, [&]() {
+      samples.push(values[++index % values.size()]);
+      bench::do_not_optimize(*std::min_element(samples.begin(), samples.end()));
+      bench::do_not_optimize(*std::max_element(samples.begin(), samples.end()));
+    }));
+    bench::print_result("push and min/max " + name, bench::measure(1, [&]() {
+      statistic.push(values[++index % values.size()]);
+      bench::do_not_optimize(statistic.min());
+      bench::do_not_optimize(statistic.max());
+    }));
+    bench::print_result("push batch of " + std::to_string(batch_size) + " " + name,
+      bench::measure(batch_size, [&]() {
+        index = (index + batch_size) % (values.size() - batch_size);
+        statistic.push(values.data() + index, batch_size);
+        bench::do_not_optimize(statistic.mean());
+      }));
+  }
+} // namespace
+
+int main(int argc, char* argv[]) {
+  if (!bench::parse_arguments(argc, argv))
+    return EXIT_FAILURE;
+
+  const auto values = create_durations(1 << 16);
+  auto failures = size_t{ };
+  for (auto capacity : { 1, 2, 7, 64, 1000 })
+    failures += verify<0>(capacity, values);
+  failures += verify<120>(120, values);
+  if (failures)
+    return EXIT_FAILURE;
+  std::printf("windowed statistics match\n");
+
+  bench::print_header("WindowedStatistic");
+  benchmark_window<0>("window 16", 16, values);
+  benchmark_window<0>("window 256", 256, values);
+  benchmark_window<0>("window 4096", 4096, values);
+  benchmark_window<120>("fixed window 120", 120, values);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,201 @@
+
+// Verifies that string_to_value and value_to_string produce the same results
+// as the iostream implementation they fall back to, then compares their
+// throughput for scalars and vectors.
+
+#include "Benchmark.h"
+#include "rxext_util.h"
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <string>
+
+using namespace rxext;
+
+namespace {
+  template<typename T>
+  std::string type_name() {
+    if constexpr (std::is_same_v<T, bool>) return "bool";
+    else if constexpr (std::is_same_v<T, int>) return "int";
+    else if constexpr (std::is_same_v<T, size_t>) return "size_t";
+    else if constexpr (std::is_same_v<T, int64_t>) return "int64_t";
+    else if constexpr (std::is_same_v<T, float>) return "float";
+    else if constexpr (std::is_same_v<T, double>) return "double";
+    else return "vector<" + type_name<typename T::value_type>() + ">";
+  }
+
+  template<typename T>
+  bool equal(const T& a, const T& b) {
+    if constexpr (detail::is_vector<T>::value) {
+      if (a.size() != b.size())
+        return false;
+      for (auto i = size_t{ }; i < a.size(); ++i)
+        if (!equal<typename T::value_type>(a[i], b[i]))
+          return false;
+      return true;
+    }
+    else if constexpr (std::is_floating_point_v<T>) {
+      return (std::isnan(a) ? std::isnan(b) : !std::memcmp(&a, &b, sizeof(T)));
+    }
+    else {
+      return (a == b);
+    }
+  }
+
+  class Verifier {
+  public:
+    template<typename T>
+    void check_string(std::string_view str) {
+      const auto value = string_to_value<T>(string(str));
+      const auto expected = detail::stream_to_value<T>(str);
+      if (!equal(value, expected))
+        fail(type_name<T>() + " parsing \"" + escape(str) + "\"");
+    }
+
+    template<typename T>
+    void check_value(const T& value) {
+      const auto str = value_to_string(value);
+      const auto expected = detail::value_to_stream_string(value);
+      if (std::string_view(str) != expected) {
+        fail(type_name<T>() + " formatting \"" + escape(expected) + "\"");
+        return;
+      }
+      check_string<T>(expected);
+    }
+
+    size_t failures() const { return m_failures; }
+
+  private:
+    static std::string escape(std::string_view str) {
+      auto result = std::string();
+      for (auto c : str)
+        result += (c == '\v' ? std::string("\\v") : std::string(1, c));
+      return result;
+    }
+
+    void fail(const std::string& message) {
+      if (++m_failures <= 20)
+        std::fprintf(stderr, "mismatch: %s\n", message.c_str());
+    }
+
+    size_t m_failures{ };
+  };
+
+  template<typename T>
+  T random_value(std::mt19937_64& random) {
+    if constexpr (std::is_same_v<T, bool>) {
+      return (random() & 1);
+    }
+    else if constexpr (std::is_integral_v<T>) {
+      // mix of small and full range values
+      const auto value = static_cast<T>(random());
+      return (random() & 1 ? value : static_cast<T>(value % 10000));
+    }
+    else {
+      const auto exponent = std::uniform_int_distribution<int>(-20, 20)(random);
+      const auto mantissa = std::uniform_real_distribution<double>(-1.0, 1.0)(random);
+      return static_cast<T>(std::ldexp(mantissa, exponent));
+    }
+  }
+
+  template<typename T>
+  void verify_type(Verifier& verifier, std::mt19937_64& random) {
+    for (auto i = 0; i < 10000; ++i)
+      verifier.check_value(random_value<T>(random));
+    verifier.check_value(std::numeric_limits<T>::min());
+    verifier.check_value(std::numeric_limits<T>::max());
+    verifier.check_value(std::numeric_limits<T>::lowest());
+    if constexpr (std::is_floating_point_v<T>) {
+      verifier.check_value(std::numeric_limits<T>::infinity());
+      verifier.check_value(-std::numeric_limits<T>::infinity());
+      verifier.check_value(std::numeric_limits<T>::quiet_NaN());
+      verifier.check_value(T{ -0.0 });
+    }
+
+    for (auto i = 0; i < 1000; ++i) {
+      auto values = std::vector<T>(random() % 8);
+      for (auto j = size_t{ }; j < values.size(); ++j)
+        values[j] = random_value<T>(random);
+      verifier.check_value(values);
+    }
+
+    // strings the iostream implementation handles differently than charconv
+    for (auto str : { "", " 5", "+5", "5 ", "-", "-0", ".5", "-.5", "1.5", "1e3", "1e400",
+        "-1", "0x10", "inf", "-inf", "nan", "true", "false", "truex", "1", "abc",
+        "1\v2", "1\v\v2", "1\v", "\v1", "1\v \v2", "1\vx\v2", "99999999999999999999" }) {
+      verifier.check_string<T>(str);
+      verifier.check_string<std::vector<T>>(str);
+    }
+  }
+
+  template<typename T>
+  void verify(Verifier& verifier) {
+    auto random = std::mt19937_64(1);
+    verify_type<T>(verifier, random);
+  }
+
+  template<typename T>
+  void benchmark_type() {
+    auto random = std::mt19937_64(2);
+    auto values = std::vector<T>(1024);
+    auto strings = std::vector<std::string>();
+    for (auto i = size_t{ }; i < values.size(); ++i) {
+      values[i] = random_value<T>(random);
+      strings.push_back(detail::value_to_stream_string(T{ values[i] }));
+    }
+    const auto vector = std::vector<T>(values.begin(), values.begin() + 16);
+    const auto vector_string = detail::value_to_stream_string(vector);
+    const auto name = type_name<T>();
+    auto index = size_t{ };
+
+    bench::print_result("iostream value_to_string " + name, bench::measure(1, [&]() {
+      bench::do_not_optimize(detail::value_to_stream_string(T{ values[++index % values.size()] }).size());
+    }));
+    bench::print_result("value_to_string " + name, bench::measure(1, [&]() {
+      bench::do_not_optimize(value_to_string(T{ values[++index % values.size()] }).size());
+    }));
+    bench::print_result("iostream string_to_value " + name, bench::measure(1, [&]() {
+      bench::do_not_optimize(detail::stream_to_value<T>(strings[++index % strings.size()]));
+    }));
+    bench::print_result("string_to_value " + name, bench::measure(1, [&]() {
+      bench::do_not_optimize(string_to_value<T>(strings[++index % strings.size()]));
+    }));
+    bench::print_result("iostream value_to_string vector<" + name + ">[16]", bench::measure(1, [&]() {
+      bench::do_not_optimize(detail::value_to_stream_string(vector).size());
+    }));
+    bench::print_result("value_to_string vector<" + name + ">[16]", bench::measure(1, [&]() {
+      bench::do_not_optimize(value_to_string(vector).size());
+    }));
+    bench::print_result("iostream string_to_value vector<" + name + ">[16]", bench::measure(1, [&]() {
+      bench::do_not_optimize(detail::stream_to_value<std::vector<T>>(vector_string).size());
+    }));
+    bench::print_result("string_to_value vector<" + name + ">[16]", bench::measure(1, [&]() {
+      bench::do_not_optimize(string_to_value<std::vector<T>>(vector_string).size());
+    }));
+  }
+} // namespace
+
+int main(int argc, char* argv[]) {
+  if (!bench::parse_arguments(argc, argv))
+    return EXIT_FAILURE;
+
+  auto verifier = Verifier();
+  verify<bool>(verifier);
+  verify<int>(verifier);
+  verify<size_t>(verifier);
+  verify<int64_t>(verifier);
+  verify<float>(verifier);
+  verify<double>(verifier);
+  if (verifier.failures()) {
+    std::fprintf(stderr, "%zu conversions differ from iostream\n", verifier.failures());
+    return EXIT_FAILURE;
+  }
+  std::printf("all conversions match iostream\n");
+
+  bench::print_header("string conversion");
+  benchmark_type<bool>();
+  benchmark_type<int>();
+  benchmark_type<double>();
+  return EXIT_SUCCESS;
+}
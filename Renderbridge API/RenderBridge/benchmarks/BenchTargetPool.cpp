@@ -0,0 +1,185 @@
+// Drives a MemoryOutputStream with a CPU timeline against a host, which completes
+// the downloads of the targets when told to. Verifies that a target presented again
+// while it is still downloading is only reused and signalled once all its downloads
+// completed, then measures a frame of get_target, before_render and present.
+
+#include "Benchmark.h"
+#include "rxext_client.h"
+#include "Host.h"
+#include <deque>
+#include <string>
+
+using namespace rxext;
+
+namespace {
+  // forwards to the headless host, but keeps the downloads until they are completed
+  class DeferringHost : public HostContextP {
+  public:
+    explicit DeferringHost(headless::Host& host)
+      : HostContextP{
+        [](HostContextP* p, EventSeverity severity, EventCategory category, string_view message) noexcept {
+          inner(p)->send_event(inner(p), severity, category, message);
+        },
+        [](HostContextP* p, const char* name, double value, bool average) noexcept {
+          inner(p)->monitor_value(inner(p), name, value, average);
+        },
+        [](HostContextP* p, string_view storage_filename) noexcept {
+          return inner(p)->resolve_storage_filename(inner(p), storage_filename);
+        },
+        [](HostContextP* p, string_view path) noexcept {
+          return inner(p)->get_userdata_path(inner(p), path);
+        },
+        [](HostContextP* p, AsyncPolicy policy, double delay_seconds, OnComplete callback) noexcept {
+          inner(p)->async(inner(p), policy, delay_seconds, std::move(callback));
+        },
+        [](HostContextP* p, const TextureDesc* desc) {
+          return inner(p)->create_texture(inner(p), desc);
+        },
+        [](HostContextP* p, TextureP* texture, OnTextureDownloaded on_downloaded) noexcept {
+          cast(p)->m_downloads.push_back({ TextureRef(texture), std::move(on_downloaded) });
+        },
+        [](HostContextP* p, TextureP* texture, const BufferDesc* buffer,
+            bool upload_copy, OnComplete callback) noexcept {
+          inner(p)->upload_texture(inner(p), texture, buffer, upload_copy, std::move(callback));
+        },
+        [](HostContextP* p, const VideoFrame* video_frame,
+            OnComplete on_data_read, OnVideoFrameUnpackedP on_unpacked) noexcept {
+          inner(p)->unpack_video_frame(inner(p), video_frame,
+            std::move(on_data_read), std::move(on_unpacked));
+        },
+        [](HostContextP* p, const AudioFrame* frame, OnComplete on_complete) noexcept {
+          inner(p)->send_audio_frame(inner(p), frame, std::move(on_complete));
+        },
+      },
+      m_host(host) { }
+
+    size_t downloads_pending() const { return m_downloads.size(); }
+
+    // completes the pending download at index, in the order they were started
+    TextureP* complete_download(size_t index) {
+      auto download = std::move(m_downloads[index]);
+      m_downloads.erase(m_downloads.begin() + static_cast<std::ptrdiff_t>(index));
+      download.on_downloaded(BufferDesc{ });
+      return download.texture.get();
+    }
+
+  private:
+    struct Download {
+      TextureRef texture;
+      OnTextureDownloaded on_downloaded;
+    };
+
+    static DeferringHost* cast(HostContextP* p) { return static_cast<DeferringHost*>(p); }
+    static HostContextP* inner(HostContextP* p) { return &cast(p)->m_host; }
+
+    headless::Host& m_host;
+    std::deque<Download> m_downloads;
+  };
+
+  class Output : public MemoryOutputStream {
+  public:
+    Output(size_t target_pool_size)
+      : MemoryOutputStream({ 16, 16, Format::R8G8B8A8_UNORM, true }, target_pool_size, true) { }
+
+    using MemoryOutputStream::get_target;
+    using MemoryOutputStream::before_render;
+    using MemoryOutputStream::present;
+
+    uint64_t timeline_value() {
+      const auto timeline = static_cast<CpuTimelineP*>(before_render().share_handle.handle);
+      return timeline->get_value(timeline);
+    }
+
+  private:
+    bool send_texture_data(const BufferDesc&) noexcept override { return true; }
+  };
+
+  void initialize(Output& output, HostContextP& host) {
+    static_cast<OutputStreamP&>(output).initialize(&output, &host);
+  }
+
+  size_t g_failures{ };
+
+  void check(bool condition, const char* message) {
+    if (!condition) {
+      std::fprintf(stderr, "%s\n", message);
+      ++g_failures;
+    }
+  }
+
+  void verify_present_while_downloading(headless::Host& headless_host) {
+    auto host = DeferringHost(headless_host);
+    auto output = Output(2);
+    initialize(output, host);
+
+    // downloads 1 and 2 of both targets, then 3 of the first target, which
+    // is returned again while it is still downloading
+    const auto first = output.get_target().get();
+    output.present();
+    const auto second = output.get_target().get();
+    output.present();
+    check(output.get_target().get() == first, "first target was not returned while downloading");
+    check(output.before_render().value == 1, "host does not wait for first download");
+    output.present();
+    check(output.target_pool_stats().downloads_outstanding == 3, "downloads are not outstanding");
+
+    // first download completes, but the first target is still downloading
+    check(host.complete_download(0) == first, "downloads were not started in order");
+    check(output.timeline_value() == 1, "first download was not signalled");
+    check(output.get_target().get() == second, "target was reused while downloading");
+    check(output.before_render().value == 2, "host does not wait for second download");
+
+    // third download completes before the second, which is not signalled yet
+    check(host.complete_download(1) == first, "third download was not pending");
+    check(output.timeline_value() == 1, "third download was signalled before the second");
+
+    // the second target is current, so only the first target becomes free
+    check(host.complete_download(0) == second, "second download was not pending");
+    check(output.timeline_value() == 3, "downloads were not signalled");
+    output.present();
+    check(output.get_target().get() == first, "first target was not freed");
+    output.present();
+    check(output.get_target().get() == second, "second target was not returned while downloading");
+    output.present();
+
+    while (host.downloads_pending())
+      host.complete_download(0);
+    check(output.timeline_value() == 6, "downloads were not signalled");
+    check(output.target_pool_stats().downloads_outstanding == 0, "downloads are outstanding");
+    check(output.get_target().get() == first, "free targets are not in completion order");
+    output.present();
+    check(output.get_target().get() == second, "free targets are not in completion order");
+    output.present();
+    while (host.downloads_pending())
+      host.complete_download(0);
+  }
+
+  void benchmark_frames(headless::Host& headless_host) {
+    bench::print_header("get_target, before_render and present");
+    for (auto downloads_in_flight : { size_t{ 1 }, size_t{ 3 }, size_t{ 6 } }) {
+      auto host = DeferringHost(headless_host);
+      auto output = Output(4);
+      initialize(output, host);
+      bench::print_result("downloads in flight=" + std::to_string(downloads_in_flight),
+        bench::measure(1, [&]() {
+          bench::do_not_optimize(output.get_target());
+          bench::do_not_optimize(output.before_render());
+          output.present();
+          while (host.downloads_pending() > downloads_in_flight)
+            host.complete_download(0);
+        }));
+      while (host.downloads_pending())
+        host.complete_download(0);
+    }
+  }
+} // namespace
+
+int main(int argc, char* argv[]) {
+  if (!bench::parse_arguments(argc, argv))
+    return EXIT_FAILURE;
+
+  auto host = headless::Host({ });
+  verify_present_while_downloading(host);
+  benchmark_frames(host);
+  return (g_failures ? EXIT_FAILURE : EXIT_SUCCESS);
+}
@@ -0,0 +1,96 @@
+
+// Compares converting the rows of RGBA images to BGRA on the calling thread
+// with parallel_for on a work-stealing ThreadPool, verifies the results match,
+// and measures the overhead of running a per-frame TaskGraph of four stages.
+
+#include "Benchmark.h"
+#include "util/ThreadPool.h"
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+  const size_t rows_per_job = 16;
+
+  struct Image {
+    size_t width;
+    size_t height;
+    std::vector<uint8_t> data;
+  };
+
+  Image create_image(size_t width, size_t height) {
+    auto image = Image{ width, height, std::vector<uint8_t>(width * height * 4) };
+    for (auto i = size_t{ }; i < image.data.size(); ++i)
+      image.data[i] = static_cast<uint8_t>(i * 7);
+    return image;
+  }
+
+  void convert_rows(const Image& source, Image& dest, size_t begin, size_t end) {
+    const auto pitch = source.width * 4;
+    for (auto y = begin; y < end; ++y) {
+      const auto src = source.data.data() + y * pitch;
+      const auto dst = dest.data.data() + y * pitch;
+      for (auto x = size_t{ }; x < pitch; x += 4) {
+        dst[x + 0] = src[x + 2];
+        dst[x + 1] = src[x + 1];
+        dst[x + 2] = src[x + 0];
+        dst[x + 3] = src[x + 3];
+      }
+    }
+  }
+
+  void benchmark_convert(util::ThreadPool& pool, size_t width, size_t height) {
+    const auto name = std::to_string(width) + "x" + std::to_string(height);
+    const auto source = create_image(width, height);
+    auto serial = create_image(width, height);
+    auto parallel = create_image(width, height);
+
+    bench::print_result("convert rows serial " + name, bench::measure(1, [&]() {
+      convert_rows(source, serial, 0, height);
+      bench::do_not_optimize(serial.data[0]);
+    }));
+    bench::print_result("convert rows parallel_for " + name, bench::measure(1, [&]() {
+      util::parallel_for(pool, 0, height, rows_per_job, [&](size_t begin, size_t end) {
+        convert_rows(source, parallel, begin, end);
+      });
+      bench::do_not_optimize(parallel.data[0]);
+    }));
+
+    if (std::memcmp(serial.data.data(), parallel.data.data(), serial.data.size())) {
+      std::fprintf(stderr, "parallel_for result differs for %s\n", name.c_str());
+      std::exit(EXIT_FAILURE);
+    }
+  }
+
+  void benchmark_task_graph(util::ThreadPool& pool) {
+    // receive, convert and scale two planes, hand off
+    auto counter = std::atomic<size_t>{ };
+    const auto stage = [&]() { counter.fetch_add(1, std::memory_order_relaxed); };
+    auto graph = util::TaskGraph();
+    const auto receive = graph.add(stage);
+    const auto convert_luma = graph.add(stage, { receive });
+    const auto convert_chroma = graph.add(stage, { receive });
+    graph.add(stage, { convert_luma, convert_chroma });
+
+    bench::print_result("TaskGraph run of 4 stages", bench::measure(1, [&]() {
+      graph.run(pool);
+    }));
+    bench::print_result("parallel_for of a single chunk", bench::measure(1, [&]() {
+      util::parallel_for(pool, 0, rows_per_job, rows_per_job,
+        [&](size_t, size_t) { stage(); });
+    }));
+    bench::do_not_optimize(counter.load());
+  }
+} // namespace
+
+int main(int argc, char* argv[]) {
+  if (!bench::parse_arguments(argc, argv))
+    return EXIT_FAILURE;
+
+  auto pool = util::get_shared_thread_pool();
+  bench::print_header("ThreadPool with " + std::to_string(pool->thread_count()) + " threads");
+  benchmark_convert(*pool, 1920, 1080);
+  benchmark_convert(*pool, 3840, 2160);
+  benchmark_task_graph(*pool);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,113 @@
+
+// Compares querying and updating settings in a ValueSet, which searches
+// names linearly and parses strings on every access, with an IndexedValueSet,
+// which hashes names and caches the typed values.
+
+#include "Benchmark.h"
+#include "rxext_util.h"
+#include <string>
+
+using namespace rxext;
+
+namespace {
+  const size_t value_counts[] = { 4, 16, 64 };
+
+  // sets ints, doubles and strings alternately, returns the name of the last of each type
+  ValueSet create_value_set(size_t value_count) {
+    auto value_set = ValueSet();
+    for (auto i = size_t{ }; i < value_count; ++i) {
+      const auto name = "value" + std::to_string(i);
+      switch (i % 3) {
+        case 0: value_set.set(name, static_cast<int>(i) * 1920); break;
+        case 1: value_set.set(name, static_cast<double>(i) / 3.0); break;
+        case 2: value_set.set(name, "setting " + std::to_string(i)); break;
+      }
+    }
+    return value_set;
+  }
+
+  std::string last_name(size_t value_count, size_t type) {
+    auto i = value_count - 1;
+    while (i % 3 != type)
+      --i;
+    return "value" + std::to_string(i);
+  }
+
+  std::string format_case(const char* name, size_t value_count) {
+    return std::string(name) + " values=" + std::to_string(value_count);
+  }
+
+  template<typename Set>
+  void benchmark_set(const char* title, const Set& initial, size_t value_count) {
+    const auto int_name = last_name(value_count, 0);
+    const auto double_name = last_name(value_count, 1);
+    const auto string_name = last_name(value_count, 2);
+    auto set = initial;
+
+    bench::print_result(format_case((std::string(title) + " get<int>").c_str(), value_count),
+      bench::measure(1, [&]() {
+        bench::do_not_optimize(set.template get<int>(int_name));
+      }));
+
+    bench::print_result(format_case((std::string(title) + " get<double>").c_str(), value_count),
+      bench::measure(1, [&]() {
+        bench::do_not_optimize(set.template get<double>(double_name));
+      }));
+
+    bench::print_result(format_case((std::string(title) + " get<string>").c_str(), value_count),
+      bench::measure(1, [&]() {
+        bench::do_not_optimize(set.get(string_name, "").size());
+      }));
+
+    bench::print_result(format_case((std::string(title) + " get missing").c_str(), value_count),
+      bench::measure(1, [&]() {
+        bench::do_not_optimize(set.template get<int>("missing", 1));
+      }));
+
+    auto value = 0;
+    bench::print_result(format_case((std::string(title) + " set<int>").c_str(), value_count),
+      bench::measure(1, [&]() {
+        set.set(int_name, ++value);
+      }));
+
+    bench::print_result(format_case((std::string(title) + " set<int>, get<int>").c_str(), value_count),
+      bench::measure(2, [&]() {
+        set.set(int_name, ++value);
+        bench::do_not_optimize(set.template get<int>(int_name));
+      }));
+  }
+
+  void benchmark_conversion(const ValueSet& value_set, size_t value_count) {
+    bench::print_result(format_case("IndexedValueSet from ValueSet", value_count),
+      bench::measure(1, [&]() {
+        bench::do_not_optimize(IndexedValueSet(value_set).size());
+      }));
+
+    auto indexed = IndexedValueSet(value_set);
+    bench::print_result(format_case("IndexedValueSet to ValueSet", value_count),
+      bench::measure(1, [&]() {
+        bench::do_not_optimize(indexed.value_set().values.size());
+      }));
+
+    auto value = 0;
+    bench::print_result(format_case("IndexedValueSet set<int>, to ValueSet", value_count),
+      bench::measure(1, [&]() {
+        indexed.set(last_name(value_count, 0), ++value);
+        bench::do_not_optimize(indexed.value_set().values.size());
+      }));
+  }
+} // namespace
+
+int main(int argc, char* argv[]) {
+  if (!bench::parse_arguments(argc, argv))
+    return EXIT_FAILURE;
+
+  for (auto value_count : value_counts) {
+    const auto value_set = create_value_set(value_count);
+    bench::print_header("ValueSet with " + std::to_string(value_count) + " values");
+    benchmark_set("ValueSet", value_set, value_count);
+    benchmark_set("IndexedValueSet", IndexedValueSet(value_set), value_count);
+    benchmark_conversion(value_set, value_count);
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,190 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+
+#if defined(_MSC_VER)
+#  include <intrin.h>
+#endif
+
+#if defined(__linux__)
+#  include <linux/perf_event.h>
+#  include <sys/ioctl.h>
+#  include <sys/syscall.h>
+#  include <unistd.h>
+#endif
+
+namespace bench {
+
+// hardware counters of the calling thread, unavailable when not permitted
+class PerfCounters {
+public:
+  PerfCounters() {
+#if defined(__linux__)
+    m_cache_misses = open(PERF_COUNT_HW_CACHE_MISSES, -1);
+    if (m_cache_misses >= 0)
+      m_instructions = open(PERF_COUNT_HW_INSTRUCTIONS, m_cache_misses);
+#endif
+  }
+  PerfCounters(const PerfCounters&) = delete;
+  PerfCounters& operator=(const PerfCounters&) = delete;
+  ~PerfCounters() {
+#if defined(__linux__)
+    if (m_instructions >= 0)
+      close(m_instructions);
+    if (m_cache_misses >= 0)
+      close(m_cache_misses);
+#endif
+  }
+
+  bool available() const { return (m_cache_misses >= 0); }
+
+  void start() {
+#if defined(__linux__)
+    if (available()) {
+      ioctl(m_cache_misses, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+      ioctl(m_cache_misses, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+#endif
+  }
+
+  void stop() {
+#if defined(__linux__)
+    if (available()) {
+      ioctl(m_cache_misses, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+      m_cache_miss_count = read_value(m_cache_misses);
+      m_instruction_count = read_value(m_instructions);
+    }
+#endif
+  }
+
+  uint64_t cache_misses() const { return m_cache_miss_count; }
+  uint64_t instructions() const { return m_instruction_count; }
+
+private:
+#if defined(__linux__)
+  static int open(uint64_t config, int group) {
+    auto attr = perf_event_attr{ };
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = config;
+    attr.disabled = (group < 0 ? 1 : 0);
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, group, 0));
+  }
+
+  static uint64_t read_value(int fd) {
+    auto value = uint64_t{ };
+    if (fd < 0 || ::read(fd, &value, sizeof(value)) != sizeof(value))
+      return 0;
+    return value;
+  }
+#endif
+
+  int m_cache_misses{ -1 };
+  int m_instructions{ -1 };
+  uint64_t m_cache_miss_count{ };
+  uint64_t m_instruction_count{ };
+};
+
+struct Result {
+  double ns_per_call;
+  double cache_misses_per_call;
+  double instructions_per_call;
+  bool counters_available;
+};
+
+struct Settings {
+  std::chrono::duration<double> min_time{ 0.2 };
+};
+
+inline Settings& settings() {
+  static auto settings = Settings{ };
+  return settings;
+}
+
+// parses common command line arguments, returns false when the program should exit
+inline bool parse_arguments(int argc, char* argv[]) {
+  for (auto i = 1; i < argc; ++i) {
+    const auto option = std::string_view(argv[i]);
+    if (option == "--min-time" && i + 1 < argc) {
+      settings().min_time = std::chrono::duration<double>(std::atof(argv[++i]));
+    }
+    else {
+      std::fprintf(stderr, "usage: %s [--min-time <seconds per case>]\n", argv[0]);
+      return false;
+    }
+  }
+  return true;
+}
+
+// calls function repeatedly for at least the minimum time,
+// calls_per_iteration is the number of calls each invocation performs
+template<typename F>
+Result measure(size_t calls_per_iteration, F&& function) {
+  using Clock = std::chrono::steady_clock;
+
+  // warm up caches and estimate iteration count
+  auto iterations = size_t{ 1 };
+  for (;;) {
+    const auto start = Clock::now();
+    for (auto i = size_t{ }; i < iterations; ++i)
+      function();
+    const auto elapsed = std::chrono::duration<double>(Clock::now() - start);
+    if (elapsed > settings().min_time / 10 || iterations >= (size_t{ 1 } << 30))
+      break;
+    iterations *= 2;
+  }
+  iterations *= 10;
+
+  auto counters = PerfCounters();
+  const auto start = Clock::now();
+  counters.start();
+  for (auto i = size_t{ }; i < iterations; ++i)
+    function();
+  counters.stop();
+  const auto elapsed = std::chrono::duration<double, std::nano>(Clock::now() - start);
+
+  const auto calls = static_cast<double>(iterations * std::max(calls_per_iteration, size_t{ 1 }));
+  return {
+    elapsed.count() / calls,
+    static_cast<double>(counters.cache_misses()) / calls,
+    static_cast<double>(counters.instructions()) / calls,
+    counters.available(),
+  };
+}
+
+inline void print_header(std::string_view title) {
+  std::printf("\n%.*s\n", static_cast<int>(title.size()), title.data());
+  std::printf("%-48s %12s %14s %14s\n", "case", "ns/call", "misses/call", "instr/call");
+}
+
+inline void print_result(const std::string& name, const Result& result) {
+  if (result.counters_available)
+    std::printf("%-48s %12.2f %14.4f %14.1f\n", name.c_str(),
+      result.ns_per_call, result.cache_misses_per_call, result.instructions_per_call);
+  else
+    std::printf("%-48s %12.2f %14s %14s\n", name.c_str(), result.ns_per_call, "n/a", "n/a");
+  std::fflush(stdout);
+}
+
+// prevents the compiler from optimizing away a value
+template<typename T>
+void do_not_optimize(const T& value) {
+#if defined(_MSC_VER)
+  // escape the address, the value may be neither copyable nor volatile assignable
+  static const void* volatile sink;
+  sink = &value;
+  _ReadWriteBarrier();
+#else
+  asm volatile("" : : "r,m"(value) : "memory");
+#endif
+}
+
+} // namespace
@@ -3,6 +3,7 @@
 #include "Input.h"
 #include "Output.h"
 #include <functional>
+#include <map>
 
 namespace rxext::ndi {
 
@@ -12,27 +13,41 @@ namespace {
   // 0 sources (even when running the Test Pattern util on the local machine)
   const auto stream_timeout_seconds = 3;
 
-  vector<ValueSet> get_current_inputs(NDIlib_find_instance_type& find) {
+  // sources by name with the update in which they were last seen
+  using RecentSources = std::map<std::string, int, std::less<>>;
+
+  // returns whether a source appeared or timed out
+  bool update_recent_sources(NDIlib_find_instance_type& find, 
+      RecentSources& recent_sources, int update_index) {
+    auto changed = false;
     auto num_sources = uint32_t{ };
     auto sources = NDIlib_find_get_current_sources(&find, &num_sources);
-    auto inputs = vector<ValueSet>();
     for (auto i = 0u; i < num_sources; i++) {
+      const auto [it, inserted] = recent_sources.try_emplace(sources[i].p_ndi_name, update_index);
+      it->second = update_index;
+      changed |= inserted;
+    }
+    for (auto it = recent_sources.begin(); it != recent_sources.end(); )
+      if (update_index - it->second >= stream_timeout_seconds) {
+        it = recent_sources.erase(it);
+        changed = true;
+      }
+      else {
+        ++it;
+      }
+    return changed;
+  }
+
+  vector<ValueSet> get_inputs(const RecentSources& recent_sources) {
+    auto inputs = vector<ValueSet>();
+    for (const auto& [name, update_index] : recent_sources) {
       auto& input = inputs.emplace_back();
-      input.set(SettingNames::name, sources[i].p_ndi_name);
+      input.set(SettingNames::name, name);
       // also use stream name as handle (instead of url_address)
-      input.set(SettingNames::handle, sources[i].p_ndi_name);
+      input.set(SettingNames::handle, name);
     }
     return inputs;
   }
-
-  vector<ValueSet> merge_inputs(const std::vector<vector<ValueSet>>& recent_inputs) {
-    auto merged = vector<ValueSet>{ };
-    for (const auto& input : recent_inputs)
-      merged.insert(merged.end(), input.begin(), input.end());
-    std::sort(merged.begin(), merged.end());
-    merged.erase(std::unique(merged.begin(), merged.end()), merged.end());
-    return merged;
-  }
 } // namespace
 
 Device::~Device() {
@@ -68,18 +83,15 @@ void Device::thread_func() noexcept {
   // TODO: revert when race is fixed - enumeration also requests current streams
   std::this_thread::sleep_for(std::chrono::seconds(5));
 
-  auto recent_inputs = std::vector<vector<ValueSet>>();
-  for (;;) {
-    recent_inputs.push_back(get_current_inputs(*ndi_find));
-    if (recent_inputs.size() > stream_timeout_seconds)
-      recent_inputs.erase(recent_inputs.begin());
-    auto inputs = merge_inputs(recent_inputs);
+  // only rebuild the inputs when a source appeared or timed out
+  auto recent_sources = RecentSources();
+  for (auto update_index = 0; ; ++update_index) {
+    auto changed = update_recent_sources(*ndi_find, recent_sources, update_index);
+    auto inputs = (changed ? get_inputs(recent_sources) : vector<ValueSet>());
 
     auto lock = std::unique_lock(m_mutex);
-    if (m_current_inputs != inputs) {
-      m_current_inputs = std::move(inputs);
+    if (changed && m_inputs.update(std::move(inputs)))
       host().send_event(EventCategory::StreamsChanged);
-    }
     m_signal.wait_for(lock, std::chrono::seconds(1));
     if (m_shutdown)
       break;
@@ -94,7 +106,12 @@ string Device::get_property(string_view name) noexcept {
 
 vector<ValueSet> Device::enumerate_stream_settings() noexcept {
   auto lock = std::lock_guard(m_mutex);
-  return m_current_inputs;
+  return m_inputs.settings();
+}
+
+StreamSettingsDelta Device::enumerate_stream_settings_delta(uint64_t token) noexcept {
+  auto lock = std::lock_guard(m_mutex);
+  return m_inputs.get_delta(token);
 }
 
 InputStream* Device::create_input_stream(ValueSet settings) noexcept try {
@@ -2,7 +2,9 @@
 
 #include "rxext_client.h"
 #include "ndi.h"
+#include <condition_variable>
 #include <mutex>
+#include <thread>
 
 namespace rxext::ndi {
 
@@ -12,6 +14,7 @@ public:
   bool initialize() noexcept override;
   string get_property(string_view name) noexcept override;
   vector<ValueSet> enumerate_stream_settings() noexcept override;
+  StreamSettingsDelta enumerate_stream_settings_delta(uint64_t token) noexcept override;
   InputStream* create_input_stream(ValueSet settings) noexcept override;
   OutputStream* create_output_stream(ValueSet settings) noexcept override;
 
@@ -22,7 +25,7 @@ private:
   std::mutex m_mutex;
   std::condition_variable m_signal;
   bool m_shutdown{ false };
-  vector<ValueSet> m_current_inputs;
+  StreamSettingsTracker m_inputs;
 };
 
 } // namespace
@@ -44,6 +44,15 @@ namespace {
     }
     return false;
   }
+
+  // NDI timestamps are in 100 ns units
+  FrameTimestamps get_frame_timestamps(int64_t ndi_timestamp) {
+    auto timestamps = FrameTimestamps{ };
+    timestamps.capture_time_ns = get_timestamp_ns();
+    if (ndi_timestamp != NDIlib_recv_timestamp_undefined)
+      timestamps.presentation_time_ns = ndi_timestamp * 100;
+    return timestamps;
+  }
 } // namespace
 
 void Input::FreeVideoFrame::operator()(VideoFrame* video_frame) const {
@@ -59,7 +68,15 @@ void Input::FreeAudioFrame::operator()(AudioFrame* audio_frame) const {
 }
 
 Input::Input(const ValueSet& settings) 
-    : m_handle(settings.get(SettingNames::handle)) {
+    : CaptureThreadInputStream(get_frame_queue_settings(settings, 
+        { 4, FrameDropPolicy::LatestOnly, 20 })),
+      m_handle(settings.get(SettingNames::handle)) {
+  // state only changes with the stream mode
+  invalidate_state();
+}
+
+Input::~Input() {
+  stop_capture_thread();
 }
 
 bool Input::initialize() noexcept {
@@ -72,51 +89,45 @@ bool Input::initialize() noexcept {
     return false;
 
   m_ndi_receive = ReceivePtr(ndi_receive, &NDIlib_recv_destroy);
-  receive_frame_callchain();
-  return true;
-}
 
-void Input::set_video_callback(SendVideoFrame&& send_video_frame) noexcept {
-  auto lock = std::lock_guard(m_mutex);
-  m_send_video_frame = std::move(send_video_frame);
+  // also capture while not requested, to detect the stream mode
+  set_capture_while_idle(true);
+  return true;
 }
 
-void Input::set_audio_callback(SendAudioFrame&& send_audio_frame) noexcept {
-  auto lock = std::lock_guard(m_mutex);
-  m_send_audio_frame = std::move(send_audio_frame);
-}
+void Input::capture(bool video_requested, bool audio_requested,
+    std::chrono::milliseconds timeout) noexcept {
+  if (m_failed) {
+    wait_until(std::chrono::steady_clock::now() + timeout);
+    return;
+  }
 
-void Input::receive_frame_callchain() noexcept {
-  auto lock = std::lock_guard(m_mutex);
-  const auto receive_video = static_cast<bool>(m_send_video_frame);
-  const auto receive_audio = static_cast<bool>(m_send_audio_frame);
+  // stream mode is only written by capture thread
   auto ndi_video_frame = NDIlib_video_frame_v2_t{ };
   auto ndi_audio_frame = NDIlib_audio_frame_v2_t{ };
   const auto result = NDIlib_recv_capture_v2(m_ndi_receive.get(),
-    (receive_video || !m_resolution_x ? &ndi_video_frame : nullptr), 
-    (receive_audio || !m_audio_channel_count ? &ndi_audio_frame : nullptr), 
-    nullptr, 0);
+    (video_requested || !m_resolution_x ? &ndi_video_frame : nullptr), 
+    (audio_requested || !m_audio_channel_count ? &ndi_audio_frame : nullptr), 
+    nullptr, static_cast<uint32_t>(timeout.count()));
 
   if (result == NDIlib_frame_type_error) {
     host().log_error("NDI stream failed");
+    m_failed = true;
     return;
   }
 
   if (result == NDIlib_frame_type_video) {
     update_stream_mode(&ndi_video_frame, nullptr);
-    if (receive_video)
-      write_video_frame(VideoFramePtr(new VideoFrame{ m_ndi_receive, ndi_video_frame }));
+    auto video_frame = VideoFramePtr(new VideoFrame{ m_ndi_receive, ndi_video_frame });
+    if (video_requested)
+      write_video_frame(std::move(video_frame));
   }
   else if (result == NDIlib_frame_type_audio) {
     update_stream_mode(nullptr, &ndi_audio_frame);
-    if (receive_audio)
-      write_audio_frame(AudioFramePtr(new AudioFrame{ m_ndi_receive, ndi_audio_frame }));
+    auto audio_frame = AudioFramePtr(new AudioFrame{ m_ndi_receive, ndi_audio_frame });
+    if (audio_requested)
+      write_audio_frame(std::move(audio_frame));
   }
-
-  const auto delay = std::chrono::milliseconds(
-    result != NDIlib_frame_type_none ? 0 :
-    receive_video || receive_audio ? 1 : 250);
-  host().set_timeout(delay, std::bind(&Input::receive_frame_callchain, this));
 }
 
 void Input::write_video_frame(VideoFramePtr video_frame) noexcept {
@@ -125,6 +136,7 @@ void Input::write_video_frame(VideoFramePtr video_frame) noexcept {
   frame.resolution_x = m_resolution_x;
   frame.resolution_y = m_resolution_y;
   frame.pixel_format = m_pixel_format;
+  frame.timestamps = get_frame_timestamps(ndi_frame.timestamp);
 
   auto& plane0 = frame.planes.emplace_back();
   plane0.data = ndi_frame.p_data;
@@ -138,13 +150,14 @@ void Input::write_video_frame(VideoFramePtr video_frame) noexcept {
     plane1.pitch = ndi_frame.xres;
     plane1.size = plane1.pitch * ndi_frame.yres;
   }
-  m_send_video_frame(frame, [video_frame = std::move(video_frame)]() noexcept { });
+  send_video_frame(frame, [video_frame = std::move(video_frame)]() noexcept { });
 }
 
 void Input::write_audio_frame(AudioFramePtr audio_frame) noexcept {
   const auto& ndi_frame = audio_frame->ndi_frame;
   auto frame = rxext::AudioFrame{ };
   frame.sample_rate = ndi_frame.sample_rate;
+  frame.timestamps = get_frame_timestamps(ndi_frame.timestamp);
   auto offset = size_t{ };
   for (auto i = 0; i < ndi_frame.no_channels; ++i) {
     auto& channel = frame.channels.emplace_back();
@@ -153,11 +166,12 @@ void Input::write_audio_frame(AudioFramePtr audio_frame) noexcept {
     channel.pitch = sizeof(float);
     offset += channel.size / channel.pitch;
   }
-  m_send_audio_frame(frame, [audio_frame = std::move(audio_frame)]() noexcept { });
+  send_audio_frame(frame, [audio_frame = std::move(audio_frame)]() noexcept { });
 }
 
 void Input::update_stream_mode(const NDIlib_video_frame_v2_t* video, 
     const NDIlib_audio_frame_v2_t* audio) noexcept {
+  auto lock = std::unique_lock(m_mutex);
   auto changed = false;
   const auto update = [&](auto& property, const auto& value) {
     changed |= (std::exchange(property, value) != value); 
@@ -173,8 +187,11 @@ void Input::update_stream_mode(const NDIlib_video_frame_v2_t* video,
     update(m_audio_channel_count, audio->no_channels);
     update(m_audio_sample_rate, audio->sample_rate);
   }
-  if (changed)
+  lock.unlock();
+  if (changed) {
+    invalidate_state();
     host().send_event(EventCategory::StreamsChanged);
+  }
 }
 
 ValueSet Input::get_state() noexcept {
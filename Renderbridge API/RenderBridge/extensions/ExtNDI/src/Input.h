@@ -6,13 +6,12 @@
 
 namespace rxext::ndi {
 
-class Input : public rxext::MemoryInputStream {
+class Input : public rxext::CaptureThreadInputStream {
 public:
   Input(const ValueSet& settings);
+  ~Input() override;
 
   bool initialize() noexcept override;
-  void set_video_callback(SendVideoFrame&& send_video_frame) noexcept override;
-  void set_audio_callback(SendAudioFrame&& send_audio_frame) noexcept override;
   ValueSet get_state() noexcept override;
 
 private:
@@ -30,7 +29,8 @@ private:
   struct FreeAudioFrame { void operator()(AudioFrame*) const; };
   using AudioFramePtr = std::unique_ptr<AudioFrame, FreeAudioFrame>;
 
-  void receive_frame_callchain() noexcept;
+  void capture(bool video_requested, bool audio_requested, 
+    std::chrono::milliseconds timeout) noexcept override;
   void write_video_frame(VideoFramePtr video_frame) noexcept;
   void write_audio_frame(AudioFramePtr audio_frame) noexcept;
   void update_stream_mode(const NDIlib_video_frame_v2_t* video, 
@@ -38,9 +38,8 @@ private:
 
   const std::string m_handle;
   std::mutex m_mutex;
-  SendVideoFrame m_send_video_frame;
-  SendAudioFrame m_send_audio_frame;
   ReceivePtr m_ndi_receive;
+  bool m_failed{ };
 
   int m_resolution_x{ };
   int m_resolution_y{ };
@@ -9,7 +9,9 @@ Output::Output(const ValueSet& settings)
         settings.get<size_t>(SettingNames::resolution_x, 1920),
         settings.get<size_t>(SettingNames::resolution_y, 1080),
         Format::B8G8R8A8_UNORM
-      }),
+      }, settings.get<size_t>(SettingNames::target_pool_size, 4),
+        settings.get<bool>(SettingNames::cpu_timeline, false),
+        settings.get<bool>(SettingNames::targets_exhausted_event, false)),
       m_handle(settings.get(SettingNames::handle)),
       m_frame_rate(settings.get<double>(SettingNames::frame_rate, 60)),
       m_sync_video(settings.get<int>(SettingNames::sync_group, -1) >= 0) {
@@ -33,7 +35,7 @@ void Output::detect_video_request_callchain() noexcept {
   set_video_requested(NDIlib_send_get_no_connections(m_ndi_send.get(), 0) > 0);
 
   host().set_timeout(std::chrono::seconds(1), 
-    std::bind(&Output::detect_video_request_callchain, this));
+    [this]() noexcept { detect_video_request_callchain(); });
 } 
 
 bool Output::send_texture_data(const BufferDesc& plane) noexcept {
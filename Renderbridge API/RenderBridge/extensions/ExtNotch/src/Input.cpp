@@ -7,6 +7,8 @@
 namespace rxext::notch {
 
 namespace {
+  const auto no_property_updater = ~size_t{ };
+
   // source: https://github.com/recp/cglm/blob/master/include/cglm/cam.h
   void glm_persp_decomp(const glm::mat4& proj,
       float* nearVal, float* farVal,
@@ -231,6 +233,7 @@ bool Input::initialize() noexcept try {
 
   for (auto property : properties) {
     m_added_parameters.clear();
+    const auto first_parameter = get_parameter_count();
 
     switch (property->GetPropertyDataType()) {
       case NotchExposedProperty::PropertyDataType_Float:
@@ -247,6 +250,14 @@ bool Input::initialize() noexcept try {
         break;
     }
 
+    // texture properties are updated every frame, others when a parameter changed
+    const auto updater = m_property_updaters.size() - 1;
+    m_parameter_property_updaters.resize(first_parameter, no_property_updater);
+    m_parameter_property_updaters.resize(get_parameter_count(), updater);
+    m_property_updaters_pending.resize(m_property_updaters.size(), true);
+    m_property_updaters_continuous.resize(m_property_updaters.size(), 
+      property->GetPropertyDataType() == NotchExposedProperty::PropertyDataType_Texture);
+
     // set properties of currently added parameters
     auto active_in_layers = std::vector<int>();
     const auto layers = m_instance->notch_instance().GetLayers();
@@ -312,15 +323,25 @@ catch (const std::exception& ex) {
 }
 
 string Input::get_property(string_view name) noexcept {
-  if (name == PropertyNames::shader_export)
-    return string("NotchSampler");
-  if (name == PropertyNames::shader_file)
-    return string("data/shaders/NotchSampler.glsl");
-  if (name == PropertyNames::layer_names)
-    return value_to_string(m_instance->get_layer_names());
-  if (name == PropertyNames::layer_ids)
-    return value_to_string(m_instance->get_layer_ids());
-
+  const auto atom = Atom(name);
+  switch (atom) {
+    case Atom(PropertyNames::shader_export):
+      if (atom.is(PropertyNames::shader_export))
+        return string("NotchSampler");
+      break;
+    case Atom(PropertyNames::shader_file):
+      if (atom.is(PropertyNames::shader_file))
+        return string("data/shaders/NotchSampler.glsl");
+      break;
+    case Atom(PropertyNames::layer_names):
+      if (atom.is(PropertyNames::layer_names))
+        return value_to_string(m_instance->get_layer_names());
+      break;
+    case Atom(PropertyNames::layer_ids):
+      if (atom.is(PropertyNames::layer_ids))
+        return value_to_string(m_instance->get_layer_ids());
+      break;
+  }
   return { };
 }
 
@@ -463,9 +484,22 @@ void Input::add_property_parameters(NotchExposedPropertyImage* notch_property) {
         get_new_parameter_name(notch_property))));
 }
 
+void Input::publish_frame_interval() {
+  // published with its percentiles as "stream.<id>.frame_interval_ms"
+  const auto monitor = phase_timers();
+  const auto frame_duration = m_render_interval_manager.last_frame_duration();
+  if (!monitor || !frame_duration.count())
+    return;
+  if (!m_frame_interval_timer)
+    m_frame_interval_timer = monitor->add_value("frame_interval_ms", true);
+  monitor->push(*m_frame_interval_timer, frame_duration.count() * 1000.0);
+}
+
 bool Input::update() noexcept try { 
   // skip update/rendering when a target frame rate is set
-  if (!m_render_interval_manager.update())
+  const auto render = m_render_interval_manager.update();
+  publish_frame_interval();
+  if (!render)
     return false;
 
   // simulation is reset, when a negative time is set (documentation is wrong!)
@@ -486,8 +520,16 @@ bool Input::update() noexcept try {
       m_instance->notch_instance().SetLayer(
         layers[std::clamp(m_layer_index->value(), 0, static_cast<int>(layers.size()) - 1)]);
 
-    for (const auto& update : m_property_updaters)
-      update();
+    for_each_changed_parameter([&](size_t index, const Parameter&) {
+      if (index < m_parameter_property_updaters.size() && 
+          m_parameter_property_updaters[index] != no_property_updater)
+        m_property_updaters_pending[m_parameter_property_updaters[index]] = true;
+    });
+    for (auto i = size_t{ }; i < m_property_updaters.size(); ++i)
+      if (m_property_updaters_pending[i] || m_property_updaters_continuous[i]) {
+        m_property_updaters_pending[i] = false;
+        m_property_updaters[i]();
+      }
 
     m_instance->notch_instance().SetTime(time, time_elapsed);
   }
@@ -5,6 +5,7 @@
 #include "notch/NotchBlock.h"
 #include "util/RenderIntervalManager.h"
 #include <functional>
+#include <optional>
 #include <vector>
 
 namespace rxext::notch {
@@ -44,6 +45,7 @@ private:
   void add_property_parameters(NotchExposedPropertyInt* notch_property);
   void add_property_parameters(NotchExposedPropertyString* notch_property);
   void add_property_parameters(NotchExposedPropertyImage* notch_property);
+  void publish_frame_interval();
 
   template<typename T, typename... Args>
   T* add_parameter(const Ident& ident, Args&&... args) {
@@ -68,11 +70,16 @@ private:
   const bool m_use_property_ids{ };
   std::vector<Parameter*> m_added_parameters;
   std::vector<std::function<void()>> m_property_updaters;
+  std::vector<bool> m_property_updaters_pending;
+  std::vector<bool> m_property_updaters_continuous;
+  // index of property updater of each parameter
+  std::vector<size_t> m_parameter_property_updaters;
   ParameterValue* m_time{ };
   ParameterBool* m_visible{ };
   ParameterInt* m_layer_index{ };
   ParameterTexture* m_sampler{ };
   util::RenderIntervalManager m_render_interval_manager;
+  std::optional<Monitor::Index> m_frame_interval_timer;
   double m_prev_time{ };
   double m_max_time_elapsed{ 0.050 };
 };
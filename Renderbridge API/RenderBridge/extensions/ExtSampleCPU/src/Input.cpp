@@ -21,6 +21,7 @@ bool Input::initialize() noexcept try {
   buffer.pitch = 2 * sizeof(uint32_t);
   buffer.size = 2 * buffer.pitch;
   host().upload_texture(m_sampler.texture(), buffer, true, []() noexcept { });
+  invalidate_state();
   return true;
 }
 catch (const std::exception& ex) {
@@ -4,21 +4,14 @@
 
 namespace rxext::sample_cpu {
 
-Input2::Input2(const ValueSet& settings) {
+Input2::Input2(const ValueSet& settings) 
+    : CaptureThreadInputStream(get_frame_queue_settings(settings)) {
+  // the state never changes
+  invalidate_state();
 }
 
-void Input2::set_video_callback(SendVideoFrame&& send_video_frame) noexcept {
-  auto lock = std::lock_guard(m_mutex);
-  m_send_video_frame = std::move(send_video_frame);
-}
-
-bool Input2::initialize() noexcept try {
-  receive_frame_callchain();
-  return true;
-}
-catch (const std::exception& ex) {
-  host().log_error(std::string("initializing input failed: ") + ex.what());
-  return false;
+Input2::~Input2() {
+  stop_capture_thread();
 }
 
 ValueSet Input2::get_state() noexcept {
@@ -29,13 +22,22 @@ ValueSet Input2::get_state() noexcept {
   return state;
 }
 
-void Input2::receive_frame_callchain() noexcept {
-  auto lock = std::lock_guard(m_mutex);
-  if (m_send_video_frame)
-    write_video_frame(m_frame_index++);
+void Input2::capture(bool video_requested, bool audio_requested,
+    std::chrono::milliseconds timeout) noexcept {
+  const auto now = std::chrono::steady_clock::now();
+  if (!video_requested) {
+    wait_until(now + timeout);
+    return;
+  }
 
-  const auto delay = std::chrono::milliseconds(20);
-  host().set_timeout(delay, [this]() noexcept { receive_frame_callchain(); });
+  // restart timing after video was not requested
+  const auto frame_duration = std::chrono::milliseconds(20);
+  if (m_next_frame_time + frame_duration < now)
+    m_next_frame_time = now;
+  if (!wait_until(m_next_frame_time))
+    return;
+  m_next_frame_time += frame_duration;
+  write_video_frame(m_frame_index++);
 }
 
 void Input2::write_video_frame(int index) noexcept {
@@ -45,22 +47,24 @@ void Input2::write_video_frame(int index) noexcept {
   frame.pixel_format = m_pixel_format;
 
   struct RGBA8 { uint8_t r,g,b,a; };
-  auto buffer = BufferDesc{ };
-  auto data = std::make_unique<RGBA8[]>(m_resolution_x * m_resolution_y);
-  for (auto y = 0; y < m_resolution_y; ++y)
-    for (auto x = 0; x < m_resolution_x; ++x) {
-      auto& color = data[y * m_resolution_x + x];
-      color.r = static_cast<uint8_t>((x * 255) / (m_resolution_x - 1));
-      color.g = static_cast<uint8_t>((y * 255) / (m_resolution_y - 1));
-      color.b = static_cast<uint8_t>(127);
-      color.a = static_cast<uint8_t>((std::sin(index * 0.1) + 1) * 127);
-    }
-  buffer.data = data.get();
-  buffer.pitch = m_resolution_x * sizeof(RGBA8);
-  buffer.size = m_resolution_y * buffer.pitch;
-  frame.planes.push_back(buffer);
+  auto buffers = m_frame_pool.acquire({ { m_resolution_x * sizeof(RGBA8), 
+    static_cast<size_t>(m_resolution_y) } });
+  const auto alpha = static_cast<uint8_t>((std::sin(index * 0.1) + 1) * 127);
+  const auto rows_per_job = size_t{ 16 };
+  util::parallel_for(*m_thread_pool, 0, static_cast<size_t>(m_resolution_y), rows_per_job,
+    [&](size_t begin, size_t end) {
+      for (auto y = static_cast<int>(begin); y < static_cast<int>(end); ++y)
+        for (auto x = 0; x < m_resolution_x; ++x) {
+          auto& color = reinterpret_cast<RGBA8*>(buffers.data(0) + y * buffers.pitch(0))[x];
+          color.r = static_cast<uint8_t>((x * 255) / (m_resolution_x - 1));
+          color.g = static_cast<uint8_t>((y * 255) / (m_resolution_y - 1));
+          color.b = static_cast<uint8_t>(127);
+          color.a = alpha;
+        }
+    });
+  frame.planes.push_back(buffers.plane(0));
 
-  m_send_video_frame(frame, [data = std::move(data)]() noexcept { });
+  send_video_frame(frame, buffers.release_on_complete());
 }
 
 } // namespace
@@ -1,28 +1,29 @@
 #pragma once
 
 #include "rxext_client.h"
-#include <mutex>
+#include "util/ThreadPool.h"
 
 namespace rxext::sample_cpu {
 
-class Input2 : public rxext::MemoryInputStream {
+class Input2 : public rxext::CaptureThreadInputStream {
 public:
   explicit Input2(const ValueSet& settings);
+  ~Input2() override;
 
-  bool initialize() noexcept override;
   ValueSet get_state() noexcept override;
 
 private:
-  void set_video_callback(SendVideoFrame&& send_video_frame) noexcept override;
-  void receive_frame_callchain() noexcept;
+  void capture(bool video_requested, bool audio_requested, 
+    std::chrono::milliseconds timeout) noexcept override;
   void write_video_frame(int index) noexcept;
 
-  std::mutex m_mutex;
-  SendVideoFrame m_send_video_frame;
+  FramePool m_frame_pool;
+  std::shared_ptr<util::ThreadPool> m_thread_pool{ util::get_shared_thread_pool() };
   int m_resolution_x{ 32 };
   int m_resolution_y{ 32 };
   std::string m_pixel_format{ "RGBA" };
   int m_frame_index{ };
+  std::chrono::steady_clock::time_point m_next_frame_time;
 };
 
 } // namespace
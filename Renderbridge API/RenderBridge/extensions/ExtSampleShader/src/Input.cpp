@@ -35,10 +35,17 @@ Input::Input(const ValueSet& settings) {
 }
 
 string Input::get_property(string_view name) noexcept { 
-  if (name == PropertyNames::shader_export)
-    return string("Sampler");
-  if (name == PropertyNames::shader_source)
-    return string(shader_source);
+  const auto atom = Atom(name);
+  switch (atom) {
+    case Atom(PropertyNames::shader_export):
+      if (atom.is(PropertyNames::shader_export))
+        return string("Sampler");
+      break;
+    case Atom(PropertyNames::shader_source):
+      if (atom.is(PropertyNames::shader_source))
+        return string(shader_source);
+      break;
+  }
   return { }; 
 }
 
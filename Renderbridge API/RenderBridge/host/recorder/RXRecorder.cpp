@@ -0,0 +1,62 @@
+
+// extension, which loads the extension set in RXRECORD_MODULE and records
+// the calls of the host into the file set in RXRECORD_FILE, so sessions of
+// a host like Pixera can be replayed with RXHeadless --replay
+
+#include "Module.h"
+#include "Recorder.h"
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <stdexcept>
+
+using namespace rxext;
+using namespace rxext::headless;
+
+namespace {
+  struct Session {
+    std::unique_ptr<Module> module;
+    std::unique_ptr<Recorder> recorder;
+  };
+
+  Session& session() {
+    static auto session = Session();
+    return session;
+  }
+
+  std::string get_environment(const char* name) {
+    const auto value = std::getenv(name);
+    if (!value || !*value)
+      throw std::runtime_error(std::string(name) + " is not set");
+    return value;
+  }
+} // namespace
+
+RXEXT_API ExtensionP* rxext_open() try {
+  auto& current = session();
+  if (current.recorder)
+    throw std::runtime_error("only one extension can be recorded at a time");
+  current.module = std::make_unique<Module>(get_environment("RXRECORD_MODULE"));
+  current.recorder = std::make_unique<Recorder>(get_environment("RXRECORD_FILE"));
+  if (auto extension = current.recorder->open(current.module->open()))
+    return extension;
+  current = Session();
+  return nullptr;
+}
+catch (const std::exception& ex) {
+  std::fprintf(stderr, "RXRecorder: %s\n", ex.what());
+  session() = Session();
+  return nullptr;
+}
+
+RXEXT_API void rxext_close(ExtensionP* extension) {
+  auto& current = session();
+  if (!current.recorder)
+    return;
+  current.module->close(current.recorder->close(extension));
+  if (const auto errors = current.recorder->write_errors())
+    std::fprintf(stderr, "RXRecorder: %zu writes to the recording failed\n", errors);
+  // destroy recorder before module, since it flushes the file
+  current.recorder.reset();
+  current.module.reset();
+}
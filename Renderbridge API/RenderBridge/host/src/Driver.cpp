@@ -0,0 +1,293 @@
+
+#include "Driver.h"
+#include <stdexcept>
+#include <thread>
+
+namespace rxext::headless {
+
+namespace {
+  using Clock = std::chrono::steady_clock;
+
+  const auto sync_timeout = std::chrono::seconds(1);
+
+  CpuTimelineP* get_cpu_timeline(const SyncDesc& sync) {
+    if (sync.sync_strategy != SyncStrategy::CpuTimeline ||
+        sync.share_handle.type != HandleType::RX_CPU_TIMELINE)
+      return nullptr;
+    return static_cast<CpuTimelineP*>(sync.share_handle.handle);
+  }
+
+  bool is_output_texture(ParameterP* parameter) {
+    return (parameter->type(parameter) == ParameterType::Texture &&
+      string_view(parameter->get_property(parameter, PropertyNames::direction)) == "out");
+  }
+} // namespace
+
+Driver::Driver(Host& host, const Module& module, Settings settings)
+    : m_host(host),
+      m_module(module),
+      m_settings(std::move(settings)) {
+  try {
+    if (!m_settings.record_file.empty())
+      m_recorder = std::make_unique<Recorder>(m_settings.record_file);
+    m_extension = m_module.open();
+    if (m_recorder)
+      m_extension = m_recorder->open(m_extension);
+    if (!m_extension)
+      throw std::runtime_error("opening extension failed");
+    m_api_version = std::string(m_extension->get_property(m_extension, PropertyNames::api_version));
+    if (!m_extension->initialize(m_extension, &m_host))
+      throw std::runtime_error("initializing extension failed");
+    m_extension_initialized = true;
+
+    create_device();
+    create_streams();
+  }
+  catch (...) {
+    shutdown();
+    throw;
+  }
+}
+
+Driver::~Driver() {
+  shutdown();
+}
+
+void Driver::create_device() {
+  auto settings = m_settings.device_settings;
+  if (settings.values.empty()) {
+    auto enumerated = m_extension->enumerate_stream_device_settings(m_extension);
+    if (!enumerated.empty())
+      settings = std::move(enumerated.front());
+  }
+  if (m_settings.monitor_phases && settings.get(SettingNames::monitor_id, "").empty())
+    settings.set(SettingNames::monitor_id, "0");
+  if (!m_settings.trace_file.empty())
+    settings.set(SettingNames::trace_file, m_settings.trace_file);
+
+  m_device = m_extension->create_stream_device(m_extension, std::move(settings));
+  if (!m_device)
+    throw std::runtime_error("creating stream device failed");
+  if (!m_device->initialize(m_device, &m_host))
+    throw std::runtime_error("initializing stream device failed");
+}
+
+void Driver::create_streams() {
+  auto input_settings = m_settings.input_settings;
+  if (input_settings.empty() && m_settings.output_settings.empty()) {
+    // wait for device to enumerate streams
+    const auto timeout = Clock::now() +
+      std::chrono::duration_cast<Clock::duration>(m_settings.stream_enumeration_timeout);
+    const auto delta_supported = is_api_version_supported(m_api_version, 1, 3);
+    auto token = uint64_t{ };
+    for (;;) {
+      m_host.process_main_thread_callbacks();
+      // the delta is empty while nothing changed, so polling does not copy the settings
+      auto enumerated = vector<ValueSet>();
+      if (delta_supported) {
+        auto delta = m_device->enumerate_stream_settings_delta(m_device, token);
+        token = delta.token;
+        enumerated = std::move(delta.added);
+      }
+      else {
+        enumerated = m_device->enumerate_stream_settings(m_device);
+      }
+      if (!enumerated.empty()) {
+        input_settings.push_back(std::move(enumerated.front()));
+        break;
+      }
+      if (Clock::now() > timeout)
+        throw std::runtime_error("device did not enumerate any streams");
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+  }
+
+  for (const auto& settings : input_settings) {
+    auto stream = m_device->create_input_stream(m_device, 
+      get_stream_settings(settings, "in" + std::to_string(m_inputs.size())));
+    if (!stream)
+      throw std::runtime_error("creating input stream failed");
+    m_inputs.push_back({ stream, { } });
+    if (!stream->initialize(stream, &m_host))
+      throw std::runtime_error("initializing input stream failed");
+
+    // parameter registration is complete after initialization
+    auto& input = m_inputs.back();
+    const auto count = stream->get_parameter_count(stream);
+    for (auto i = size_t{ }; i < count; ++i)
+      if (auto parameter = stream->get_parameter(stream, i))
+        if (is_output_texture(parameter))
+          input.output_textures.push_back(parameter);
+  }
+
+  for (const auto& settings : m_settings.output_settings) {
+    auto stream = m_device->create_output_stream(m_device, 
+      get_stream_settings(settings, "out" + std::to_string(m_outputs.size())));
+    if (!stream)
+      throw std::runtime_error("creating output stream failed");
+    m_outputs.push_back(stream);
+    if (!stream->initialize(stream, &m_host))
+      throw std::runtime_error("initializing output stream failed");
+  }
+
+  auto input_streams = std::vector<InputStreamP*>();
+  for (const auto& input : m_inputs)
+    input_streams.push_back(input.stream);
+  if (!m_device->set_active_streams(m_device,
+      input_streams.data(), input_streams.size(),
+      m_outputs.data(), m_outputs.size()))
+    throw std::runtime_error("activating streams failed");
+
+  for (const auto& input : m_inputs) {
+    input.stream->set_video_requested(input.stream, m_settings.video_requested);
+    input.stream->set_audio_requested(input.stream, m_settings.audio_requested);
+  }
+}
+
+void Driver::shutdown() noexcept {
+  for (const auto& input : m_inputs) {
+    input.stream->set_video_requested(input.stream, false);
+    input.stream->set_audio_requested(input.stream, false);
+  }
+
+  // no more callbacks must be executed while streams are destroyed
+  m_host.shutdown();
+
+  if (m_device)
+    m_device->set_active_streams(m_device, nullptr, 0, nullptr, 0);
+  for (auto output : m_outputs)
+    output->release(output);
+  m_outputs.clear();
+  for (const auto& input : m_inputs)
+    input.stream->release(input.stream);
+  m_inputs.clear();
+  if (m_device)
+    m_device->release(m_device);
+  m_device = nullptr;
+
+  if (m_extension_initialized)
+    m_extension->shutdown(m_extension);
+  m_extension_initialized = false;
+  if (m_extension)
+    m_module.close(m_recorder ? m_recorder->close(m_extension) : m_extension);
+  m_extension = nullptr;
+}
+
+void Driver::run(double frame_rate, size_t frame_count, std::chrono::duration<double> duration) {
+  const auto frame_duration = std::chrono::duration_cast<Clock::duration>(
+    std::chrono::duration<double>(frame_rate > 0 ? 1.0 / frame_rate : 0.0));
+  const auto start = Clock::now();
+  const auto end = start + std::chrono::duration_cast<Clock::duration>(duration);
+  auto next_frame = start;
+
+  for (auto frame = size_t{ }; !frame_count || frame < frame_count; ++frame) {
+    const auto frame_start = Clock::now();
+    if (duration.count() > 0 && frame_start >= end)
+      break;
+
+    render_frame();
+
+    const auto frame_end = Clock::now();
+    m_frame_time_ms.push(std::chrono::duration<double, std::milli>(frame_end - frame_start).count());
+
+    if (frame_duration.count()) {
+      next_frame += frame_duration;
+      if (next_frame < frame_end)
+        next_frame = frame_end;
+      else
+        std::this_thread::sleep_until(next_frame);
+    }
+  }
+  m_run_duration += Clock::now() - start;
+}
+
+void Driver::render_frame() {
+  m_host.process_main_thread_callbacks();
+
+  m_device->update(m_device);
+  for (const auto& input : m_inputs)
+    input.stream->update(input.stream);
+
+  m_device->before_render(m_device);
+  m_device->render(m_device);
+  m_device->after_render(m_device);
+
+  // the textures are accessed when rendering, so the host waits and signals right away
+  for (auto& input : m_inputs) {
+    auto stream = input.stream;
+    wait_sync(stream->before_render(stream));
+    stream->render(stream);
+    const auto after_render = stream->after_render(stream);
+    read_output_textures(input);
+    signal_sync(after_render);
+  }
+
+  for (auto output : m_outputs) {
+    // target is owned by host
+    auto target = TextureRef(output->get_target(output));
+    if (!target) {
+      ++m_output_targets_unavailable;
+      continue;
+    }
+    wait_sync(output->before_render(output));
+    signal_sync(output->after_render(output));
+    output->present(output);
+    ++m_output_targets_rendered;
+  }
+  for (auto output : m_outputs)
+    output->swap(output);
+
+  ++m_frame_index;
+}
+
+ValueSet Driver::get_stream_settings(ValueSet settings, const std::string& monitor_id) const {
+  if (m_settings.cpu_timeline && is_api_version_supported(m_api_version, 1, 3) &&
+      settings.get(SettingNames::cpu_timeline, "").empty())
+    settings.set(SettingNames::cpu_timeline, true);
+  if (is_api_version_supported(m_api_version, 1, 3) &&
+      settings.get(SettingNames::targets_exhausted_event, "").empty())
+    settings.set(SettingNames::targets_exhausted_event, true);
+  if (m_settings.monitor_phases && settings.get(SettingNames::monitor_id, "").empty())
+    settings.set(SettingNames::monitor_id, monitor_id);
+  return settings;
+}
+
+void Driver::wait_sync(const SyncDesc& sync) {
+  if (auto timeline = get_cpu_timeline(sync)) {
+    ++m_sync_waits;
+    const auto timeout_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(sync_timeout);
+    if (!timeline->wait(timeline, sync.value, static_cast<uint64_t>(timeout_ns.count())))
+      ++m_sync_timeouts;
+  }
+}
+
+void Driver::signal_sync(const SyncDesc& sync) {
+  if (auto timeline = get_cpu_timeline(sync))
+    timeline->signal(timeline, sync.value);
+}
+
+void Driver::read_output_textures(Input& input) {
+  for (auto parameter : input.output_textures) {
+    auto size = size_t{ };
+    parameter->get_value(parameter, nullptr, &size);
+    m_texture_buffer.assign(size / sizeof(TextureP*), nullptr);
+    if (m_texture_buffer.empty())
+      continue;
+    size = m_texture_buffer.size() * sizeof(TextureP*);
+    parameter->get_value(parameter, m_texture_buffer.data(), &size);
+
+    // nothing was written when the texture count increased in between
+    if (size > m_texture_buffer.size() * sizeof(TextureP*))
+      continue;
+    m_texture_buffer.resize(size / sizeof(TextureP*));
+
+    // references were acquired for caller
+    for (auto texture : m_texture_buffer)
+      if (texture) {
+        texture->release(texture);
+        ++m_input_textures_read;
+      }
+  }
+}
+
+} // namespace
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "Host.h"
+#include "Module.h"
+#include "Recorder.h"
+#include "common/statistics.h"
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace rxext::headless {
+
+// drives an extension's device and streams through the per-frame call sequence
+class Driver {
+public:
+  struct Settings {
+    // device settings, uses first enumerated when empty
+    ValueSet device_settings;
+    // stream settings, uses first enumerated input when both are empty
+    std::vector<ValueSet> input_settings;
+    std::vector<ValueSet> output_settings;
+    std::chrono::duration<double> stream_enumeration_timeout{ 10.0 };
+    bool video_requested{ true };
+    bool audio_requested{ false };
+    // announce support of SyncStrategy::CpuTimeline to streams
+    bool cpu_timeline{ true };
+    // let the device and streams publish the durations of their phases as monitor values
+    bool monitor_phases{ false };
+    // let the device record a trace, which is written to this file in the userdata path
+    std::string trace_file;
+    // record the calls into the extension to this file, for replaying them later
+    std::filesystem::path record_file;
+  };
+
+  Driver(Host& host, const Module& module, Settings settings);
+  Driver(const Driver&) = delete;
+  Driver& operator=(const Driver&) = delete;
+  ~Driver();
+
+  // frame_rate of zero renders as fast as possible, frame_count/duration of zero is unlimited
+  void run(double frame_rate, size_t frame_count, std::chrono::duration<double> duration);
+  void render_frame();
+
+  const std::string& api_version() const { return m_api_version; }
+  size_t frames_rendered() const { return m_frame_index; }
+  std::chrono::duration<double> run_duration() const { return m_run_duration; }
+  const common::OnlineStatistic<double>& frame_time_ms() const { return m_frame_time_ms; }
+  size_t input_textures_read() const { return m_input_textures_read; }
+  size_t output_targets_rendered() const { return m_output_targets_rendered; }
+  size_t output_targets_unavailable() const { return m_output_targets_unavailable; }
+  size_t sync_waits() const { return m_sync_waits; }
+  size_t sync_timeouts() const { return m_sync_timeouts; }
+  const Recorder* recorder() const { return m_recorder.get(); }
+
+private:
+  struct Input {
+    InputStreamP* stream;
+    std::vector<ParameterP*> output_textures;
+  };
+
+  void create_device();
+  void create_streams();
+  void read_output_textures(Input& input);
+  ValueSet get_stream_settings(ValueSet settings, const std::string& monitor_id) const;
+  void wait_sync(const SyncDesc& sync);
+  void signal_sync(const SyncDesc& sync);
+  void shutdown() noexcept;
+
+  Host& m_host;
+  const Module& m_module;
+  const Settings m_settings;
+  std::unique_ptr<Recorder> m_recorder;
+  ExtensionP* m_extension{ };
+  bool m_extension_initialized{ };
+  std::string m_api_version;
+  StreamDeviceP* m_device{ };
+  std::vector<Input> m_inputs;
+  std::vector<OutputStreamP*> m_outputs;
+  std::vector<TextureP*> m_texture_buffer;
+
+  size_t m_frame_index{ };
+  std::chrono::duration<double> m_run_duration{ };
+  common::OnlineStatistic<double> m_frame_time_ms;
+  size_t m_input_textures_read{ };
+  size_t m_output_targets_rendered{ };
+  size_t m_output_targets_unavailable{ };
+  size_t m_sync_waits{ };
+  size_t m_sync_timeouts{ };
+};
+
+} // namespace
@@ -0,0 +1,274 @@
+
+#include "Host.h"
+#include <cstdio>
+
+namespace rxext::headless {
+
+namespace {
+  int get_level(EventSeverity severity) {
+    return static_cast<int>(static_cast<std::ptrdiff_t>(severity));
+  }
+
+  const char* get_severity_name(EventSeverity severity) {
+    switch (severity) {
+      case EventSeverity::Verbose: return "verbose";
+      case EventSeverity::Info: return "info";
+      case EventSeverity::Warning: return "warning";
+      case EventSeverity::Error: return "error";
+    }
+    return "";
+  }
+
+  const char* get_category_name(EventCategory category) {
+    switch (category) {
+      case EventCategory::Message: return "Message";
+      case EventCategory::DevicesChanged: return "DevicesChanged";
+      case EventCategory::Failed: return "Failed";
+      case EventCategory::StreamsChanged: return "StreamsChanged";
+      case EventCategory::TargetsExhausted: return "TargetsExhausted";
+    }
+    return "";
+  }
+
+  // unpacking only copies the planes, packed formats are stored as 8 bit per component
+  TextureDesc get_plane_texture_desc(const VideoFrame& frame, const BufferDesc& plane) {
+    auto desc = TextureDesc{ };
+    desc.height = (plane.pitch ? plane.size / plane.pitch : 0);
+    const auto& pixel_format = frame.pixel_format;
+    if (frame.planes.size() == 1 && (pixel_format == "RGBA" || pixel_format == "BGRA")) {
+      desc.width = frame.resolution_x;
+      desc.format = (pixel_format == "RGBA" ?
+        Format::R8G8B8A8_UNORM : Format::B8G8R8A8_UNORM);
+    }
+    else {
+      desc.width = plane.pitch;
+      desc.format = Format::R8_UNORM;
+    }
+    return desc;
+  }
+} // namespace
+
+Host::Host(Settings settings)
+  : HostContextP{
+      [](HostContextP* p, EventSeverity severity, EventCategory category, string_view message) noexcept {
+        cast(p)->send_event(severity, category, message);
+      },
+      [](HostContextP* p, const char* name, double value, bool average) noexcept {
+        cast(p)->monitor_value(name, value, average);
+      },
+      [](HostContextP* p, string_view storage_filename) noexcept {
+        return string(storage_filename);
+      },
+      [](HostContextP* p, string_view path) noexcept {
+        return cast(p)->get_userdata_path(path);
+      },
+      [](HostContextP* p, AsyncPolicy policy, double delay_seconds, OnComplete callback) noexcept {
+        cast(p)->async(policy, delay_seconds, std::move(callback));
+      },
+      [](HostContextP* p, const TextureDesc* desc) {
+        return cast(p)->create_texture(*desc);
+      },
+      [](HostContextP* p, TextureP* texture, OnTextureDownloaded on_downloaded) noexcept {
+        cast(p)->download_texture(texture, std::move(on_downloaded));
+      },
+      [](HostContextP* p, TextureP* texture, const BufferDesc* buffer,
+          bool upload_copy, OnComplete callback) noexcept {
+        cast(p)->upload_texture(texture, *buffer, upload_copy, std::move(callback));
+      },
+      [](HostContextP* p, const VideoFrame* video_frame,
+          OnComplete on_data_read, OnVideoFrameUnpackedP on_unpacked) noexcept {
+        cast(p)->unpack_video_frame(*video_frame, std::move(on_data_read), std::move(on_unpacked));
+      },
+      [](HostContextP* p, const AudioFrame* frame, OnComplete on_complete) noexcept {
+        cast(p)->send_audio_frame(*frame, std::move(on_complete));
+      },
+    },
+    m_settings(std::move(settings)),
+    m_texture_pool(std::make_shared<TexturePool>()),
+    m_scheduler(m_settings.worker_count) {
+}
+
+Host::~Host() {
+  shutdown();
+}
+
+void Host::shutdown() {
+  m_scheduler.shutdown();
+  auto lock = std::unique_lock(m_mutex);
+  auto callbacks = std::move(m_main_thread_callbacks);
+  lock.unlock();
+}
+
+void Host::process_main_thread_callbacks() {
+  auto lock = std::unique_lock(m_mutex);
+  auto callbacks = std::move(m_main_thread_callbacks);
+  lock.unlock();
+  for (auto& callback : callbacks)
+    callback();
+}
+
+Host::Counters Host::counters() const {
+  return {
+    m_events,
+    m_streams_changed_events,
+    m_targets_exhausted_events,
+    m_async_callbacks,
+    m_textures_created,
+    m_texture_pool->textures_allocated(),
+    m_texture_pool->textures_alive(),
+    m_downloads,
+    m_download_bytes,
+    m_uploads,
+    m_upload_bytes,
+    m_video_frames_unpacked,
+    m_video_bytes_unpacked,
+    m_audio_frames,
+  };
+}
+
+std::map<std::string, Host::MonitorValue> Host::monitor_values() const {
+  auto lock = std::lock_guard(m_mutex);
+  return m_monitor_values;
+}
+
+void Host::send_event(EventSeverity severity, EventCategory category, string_view message) noexcept {
+  ++m_events;
+  if (category == EventCategory::StreamsChanged) {
+    ++m_streams_changed_events;
+    m_streams_changed = true;
+  }
+  if (category == EventCategory::TargetsExhausted)
+    ++m_targets_exhausted_events;
+  if (get_level(severity) < get_level(m_settings.log_level))
+    return;
+
+  if (category == EventCategory::Message)
+    std::fprintf(stderr, "[%s] %.*s\n", get_severity_name(severity),
+      static_cast<int>(message.size()), message.data());
+  else
+    std::fprintf(stderr, "[%s] %s %.*s\n", get_severity_name(severity),
+      get_category_name(category), static_cast<int>(message.size()), message.data());
+}
+
+void Host::monitor_value(const char* name, double value, bool average) noexcept try {
+  auto lock = std::lock_guard(m_mutex);
+  auto& monitor_value = m_monitor_values[name];
+  monitor_value.last = value;
+  monitor_value.sum += value;
+  monitor_value.count += 1;
+  monitor_value.average = average;
+}
+catch (const std::exception&) {
+}
+
+string Host::get_userdata_path(string_view path) noexcept try {
+  auto filename = m_settings.userdata_path / std::filesystem::path(path);
+  std::filesystem::create_directories(filename.parent_path());
+  return string(filename.string());
+}
+catch (const std::exception& ex) {
+  send_event(EventSeverity::Error, EventCategory::Message, ex.what());
+  return { };
+}
+
+void Host::async(AsyncPolicy policy, double delay_seconds, OnComplete callback) noexcept try {
+  ++m_async_callbacks;
+  if (policy == AsyncPolicy::MainThread && delay_seconds <= 0) {
+    auto lock = std::lock_guard(m_mutex);
+    m_main_thread_callbacks.push_back(std::move(callback));
+    return;
+  }
+  const auto delay = std::chrono::duration_cast<Scheduler::Clock::duration>(
+    std::chrono::duration<double>(delay_seconds));
+  if (policy == AsyncPolicy::MainThread) {
+    // forward to main thread after delay
+    m_scheduler.post(delay, [this, callback = std::move(callback)]() mutable noexcept {
+      async(AsyncPolicy::MainThread, 0, std::move(callback));
+    });
+    return;
+  }
+  m_scheduler.post(delay, std::move(callback));
+}
+catch (const std::exception& ex) {
+  send_event(EventSeverity::Error, EventCategory::Message, ex.what());
+}
+
+TextureP* Host::create_texture(const TextureDesc& desc) try {
+  ++m_textures_created;
+  return m_texture_pool->create(desc);
+}
+catch (const std::exception& ex) {
+  send_event(EventSeverity::Error, EventCategory::Message, ex.what());
+  return nullptr;
+}
+
+void Host::download_texture(TextureP* texture, OnTextureDownloaded on_downloaded) noexcept try {
+  m_scheduler.post([this, texture = TextureRef(texture),
+      on_downloaded = std::move(on_downloaded)]() mutable noexcept {
+    const auto buffer = Texture::cast(texture.get())->buffer();
+    ++m_downloads;
+    m_download_bytes += buffer.size;
+    on_downloaded(buffer);
+  });
+}
+catch (const std::exception& ex) {
+  send_event(EventSeverity::Error, EventCategory::Message, ex.what());
+}
+
+void Host::upload_texture(TextureP* texture, const BufferDesc& buffer,
+    bool upload_copy, OnComplete callback) noexcept try {
+  auto upload = [this, texture = TextureRef(texture), buffer,
+      callback = std::move(callback)]() mutable noexcept {
+    Texture::cast(texture.get())->write(buffer);
+    ++m_uploads;
+    m_upload_bytes += buffer.size;
+    callback();
+  };
+  if (upload_copy) {
+    // buffer is only valid during call
+    upload();
+    return;
+  }
+  m_scheduler.post(std::move(upload));
+}
+catch (const std::exception& ex) {
+  send_event(EventSeverity::Error, EventCategory::Message, ex.what());
+}
+
+void Host::unpack_video_frame(const VideoFrame& video_frame,
+    OnComplete on_data_read, OnVideoFrameUnpackedP on_unpacked) noexcept try {
+  m_scheduler.post([this, video_frame, on_data_read = std::move(on_data_read),
+      on_unpacked = std::move(on_unpacked)]() mutable noexcept {
+    auto textures = std::vector<TextureP*>();
+    auto bytes = size_t{ };
+    try {
+      for (const auto& plane : video_frame.planes) {
+        auto texture = m_texture_pool->create(get_plane_texture_desc(video_frame, plane));
+        textures.push_back(texture);
+        texture->write(plane);
+        bytes += plane.size;
+      }
+    }
+    catch (const std::exception& ex) {
+      send_event(EventSeverity::Error, EventCategory::Message, ex.what());
+      for (auto texture : textures)
+        texture->release(texture);
+      textures.clear();
+    }
+    on_data_read();
+    ++m_video_frames_unpacked;
+    m_video_bytes_unpacked += bytes;
+    // ownership of textures is passed to callback
+    on_unpacked(textures.data(), textures.size());
+  });
+}
+catch (const std::exception& ex) {
+  send_event(EventSeverity::Error, EventCategory::Message, ex.what());
+}
+
+void Host::send_audio_frame(const AudioFrame& frame, OnComplete on_complete) noexcept {
+  ++m_audio_frames;
+  on_complete();
+}
+
+} // namespace
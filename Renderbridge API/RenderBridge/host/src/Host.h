@@ -0,0 +1,102 @@
+#pragma once
+
+#include "rxext_util.h"
+#include "Scheduler.h"
+#include "Texture.h"
+#include <atomic>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace rxext::headless {
+
+// implements the host context against system memory
+class Host final : public HostContextP {
+public:
+  struct Settings {
+    EventSeverity log_level{ EventSeverity::Warning };
+    size_t worker_count{ 2 };
+    std::filesystem::path userdata_path;
+  };
+
+  struct Counters {
+    size_t events;
+    size_t streams_changed_events;
+    size_t targets_exhausted_events;
+    size_t async_callbacks;
+    size_t textures_created;
+    size_t textures_allocated;
+    size_t textures_alive;
+    size_t downloads;
+    size_t download_bytes;
+    size_t uploads;
+    size_t upload_bytes;
+    size_t video_frames_unpacked;
+    size_t video_bytes_unpacked;
+    size_t audio_frames;
+  };
+
+  struct MonitorValue {
+    double last;
+    double sum;
+    size_t count;
+    bool average;
+  };
+
+  static Host* cast(HostContextP* self) { return static_cast<Host*>(self); }
+
+  explicit Host(Settings settings);
+  Host(const Host&) = delete;
+  Host& operator=(const Host&) = delete;
+  ~Host();
+
+  // executes callbacks posted with AsyncPolicy::MainThread
+  void process_main_thread_callbacks();
+
+  // stops asynchronous execution and discards pending callbacks
+  void shutdown();
+
+  // returns whether a StreamsChanged event was sent since last call
+  bool reset_streams_changed() { return m_streams_changed.exchange(false); }
+
+  Counters counters() const;
+  std::map<std::string, MonitorValue> monitor_values() const;
+
+private:
+  void send_event(EventSeverity severity, EventCategory category, string_view message) noexcept;
+  void monitor_value(const char* name, double value, bool average) noexcept;
+  string get_userdata_path(string_view path) noexcept;
+  void async(AsyncPolicy policy, double delay_seconds, OnComplete callback) noexcept;
+  TextureP* create_texture(const TextureDesc& desc);
+  void download_texture(TextureP* texture, OnTextureDownloaded on_downloaded) noexcept;
+  void upload_texture(TextureP* texture, const BufferDesc& buffer,
+    bool upload_copy, OnComplete callback) noexcept;
+  void unpack_video_frame(const VideoFrame& video_frame,
+    OnComplete on_data_read, OnVideoFrameUnpackedP on_unpacked) noexcept;
+  void send_audio_frame(const AudioFrame& frame, OnComplete on_complete) noexcept;
+
+  const Settings m_settings;
+  const std::shared_ptr<TexturePool> m_texture_pool;
+  Scheduler m_scheduler;
+
+  mutable std::mutex m_mutex;
+  std::vector<OnComplete> m_main_thread_callbacks;
+  std::map<std::string, MonitorValue> m_monitor_values;
+  std::atomic<bool> m_streams_changed{ };
+
+  std::atomic<size_t> m_events{ };
+  std::atomic<size_t> m_streams_changed_events{ };
+  std::atomic<size_t> m_targets_exhausted_events{ };
+  std::atomic<size_t> m_async_callbacks{ };
+  std::atomic<size_t> m_textures_created{ };
+  std::atomic<size_t> m_downloads{ };
+  std::atomic<size_t> m_download_bytes{ };
+  std::atomic<size_t> m_uploads{ };
+  std::atomic<size_t> m_upload_bytes{ };
+  std::atomic<size_t> m_video_frames_unpacked{ };
+  std::atomic<size_t> m_video_bytes_unpacked{ };
+  std::atomic<size_t> m_audio_frames{ };
+};
+
+} // namespace
@@ -0,0 +1,67 @@
+
+#include "Module.h"
+#include <stdexcept>
+
+#if defined(_WIN32)
+#  define WIN32_LEAN_AND_MEAN
+#  define NOMINMAX
+#  include <Windows.h>
+#else
+#  include <dlfcn.h>
+#endif
+
+namespace rxext::headless {
+
+namespace {
+  void* load_library(const std::string& filename) {
+#if defined(_WIN32)
+    return LoadLibraryA(filename.c_str());
+#else
+    return dlopen(filename.c_str(), RTLD_NOW | RTLD_LOCAL);
+#endif
+  }
+
+  void free_library(void* handle) {
+#if defined(_WIN32)
+    FreeLibrary(static_cast<HMODULE>(handle));
+#else
+    dlclose(handle);
+#endif
+  }
+
+  std::string get_last_error() {
+#if defined(_WIN32)
+    return "error " + std::to_string(GetLastError());
+#else
+    const auto error = dlerror();
+    return (error ? error : "");
+#endif
+  }
+} // namespace
+
+Module::Module(const std::string& filename)
+    : m_handle(load_library(filename)) {
+  if (!m_handle)
+    throw std::runtime_error("loading '" + filename + "' failed: " + get_last_error());
+
+  m_open = reinterpret_cast<decltype(m_open)>(get_symbol("rxext_open"));
+  m_close = reinterpret_cast<decltype(m_close)>(get_symbol("rxext_close"));
+  if (!m_open || !m_close) {
+    free_library(m_handle);
+    throw std::runtime_error("'" + filename + "' is not an extension");
+  }
+}
+
+Module::~Module() {
+  free_library(m_handle);
+}
+
+void* Module::get_symbol(const char* name) const {
+#if defined(_WIN32)
+  return reinterpret_cast<void*>(GetProcAddress(static_cast<HMODULE>(m_handle), name));
+#else
+  return dlsym(m_handle, name);
+#endif
+}
+
+} // namespace
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "rxext.h"
+#include <memory>
+#include <string>
+
+namespace rxext::headless {
+
+// loads an extension binary and resolves its exported functions
+class Module {
+public:
+  explicit Module(const std::string& filename);
+  Module(const Module&) = delete;
+  Module& operator=(const Module&) = delete;
+  ~Module();
+
+  ExtensionP* open() const { return m_open(); }
+  void close(ExtensionP* extension) const { m_close(extension); }
+
+  // resolves an arbitrary exported symbol, returns nullptr when not found
+  void* get_symbol(const char* name) const;
+
+private:
+  void* m_handle{ };
+  ExtensionP* (*m_open)(){ };
+  void (*m_close)(ExtensionP*){ };
+};
+
+} // namespace
@@ -0,0 +1,671 @@
+
+#include "Recorder.h"
+#include <map>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace rxext::headless {
+
+namespace {
+  // arguments and result of the current call, the host does not nest calls
+  Encoder& get_payload() {
+    static thread_local auto payload = Encoder();
+    payload.clear();
+    return payload;
+  }
+
+  // textures are recorded by their description
+  void put_parameter_value(Encoder& payload, ParameterType type, const void* data, size_t size) {
+    payload.put_unsigned(static_cast<uint64_t>(type));
+    if (type != ParameterType::Texture)
+      return payload.put_bytes(data, size);
+
+    const auto textures = static_cast<TextureP* const*>(data);
+    const auto count = (data ? size / sizeof(TextureP*) : 0);
+    payload.put_unsigned(count);
+    for (auto i = size_t{ }; i < count; ++i) {
+      const auto desc = (textures[i] ? textures[i]->get_desc(textures[i]) : nullptr);
+      payload.put_bool(desc != nullptr);
+      if (desc)
+        payload.put_texture_desc(*desc);
+    }
+  }
+
+  class RecordedObject {
+  public:
+    explicit RecordedObject(Recorder& recorder)
+      : m_recorder(recorder), m_id(recorder.next_object_id()) { }
+
+    uint64_t id() const { return m_id; }
+
+  protected:
+    // calls function, appends its result to the payload and writes the record
+    template<typename F>
+    auto record(Call call, Encoder& payload, F&& function) const {
+      const auto start = Recorder::Clock::now();
+      if constexpr (std::is_void_v<decltype(function())>) {
+        function();
+        m_recorder.write(call, m_id, start, Recorder::Clock::now(), payload);
+      }
+      else {
+        auto result = function();
+        const auto end = Recorder::Clock::now();
+        put_result(payload, result);
+        m_recorder.write(call, m_id, start, end, payload);
+        return result;
+      }
+    }
+
+    template<typename F>
+    auto record(Call call, F&& function) const {
+      return record(call, get_payload(), std::forward<F>(function));
+    }
+
+    Recorder& m_recorder;
+    const uint64_t m_id;
+
+  private:
+    // results, which the replay can compare, and created objects
+    template<typename T>
+    static void put_result(Encoder& payload, const T& result) {
+      if constexpr (std::is_same_v<T, bool> || std::is_same_v<T, size_t>)
+        payload.put_unsigned(result);
+      else if constexpr (std::is_enum_v<T>)
+        payload.put_unsigned(static_cast<uint64_t>(result));
+      else if constexpr (std::is_base_of_v<RecordedObject, std::remove_pointer_t<T>>)
+        payload.put_unsigned(result ? result->id() : 0);
+      else if constexpr (std::is_same_v<T, TextureP*>) {
+        const auto desc = (result ? result->get_desc(result) : nullptr);
+        payload.put_bool(desc != nullptr);
+        if (desc)
+          payload.put_texture_desc(*desc);
+      }
+    }
+  };
+
+  class RecordedParameter final : public ParameterP, public RecordedObject {
+  public:
+    static const RecordedParameter* cast(const ParameterP* self) {
+      return static_cast<const RecordedParameter*>(self);
+    }
+
+    RecordedParameter(Recorder& recorder, ParameterP* inner)
+      : ParameterP{
+          [](const ParameterP* p) noexcept {
+            const auto self = cast(p);
+            return self->record(Call::parameter_type, [&]() {
+              return self->m_inner->type(self->m_inner);
+            });
+          },
+          [](const ParameterP* p) noexcept {
+            const auto self = cast(p);
+            return self->record(Call::parameter_name, [&]() {
+              return self->m_inner->name(self->m_inner);
+            });
+          },
+          [](ParameterP* p, const void* data, size_t size) noexcept {
+            const auto self = cast(p);
+            auto& payload = get_payload();
+            put_parameter_value(payload, self->m_type, data, size);
+            self->record(Call::parameter_set_value, payload, [&]() {
+              self->m_inner->set_value(self->m_inner, data, size);
+            });
+          },
+          [](const ParameterP* p, void* data, size_t* size) noexcept {
+            const auto self = cast(p);
+            auto& payload = get_payload();
+            payload.put_bool(data != nullptr);
+            payload.put_bool(size != nullptr);
+            payload.put_unsigned(size ? *size : 0);
+            self->record(Call::parameter_get_value, payload, [&]() {
+              self->m_inner->get_value(self->m_inner, data, size);
+            });
+          },
+          [](ParameterP* p, string_view name, string value) noexcept {
+            const auto self = cast(p);
+            auto& payload = get_payload();
+            payload.put_string(name);
+            payload.put_string(value);
+            return self->record(Call::parameter_set_property, payload, [&]() {
+              return self->m_inner->set_property(self->m_inner, name, std::move(value));
+            });
+          },
+          [](const ParameterP* p, string_view name) noexcept {
+            const auto self = cast(p);
+            auto& payload = get_payload();
+            payload.put_string(name);
+            return self->record(Call::parameter_get_property, payload, [&]() {
+              return self->m_inner->get_property(self->m_inner, name);
+            });
+          },
+        },
+        RecordedObject(recorder),
+        m_inner(inner),
+        m_type(inner->type(inner)) {
+    }
+
+  private:
+    ParameterP* const m_inner;
+    const ParameterType m_type;
+  };
+
+  class RecordedInputStream final : public InputStreamP, public RecordedObject {
+  public:
+    static RecordedInputStream* cast(InputStreamP* self) {
+      return static_cast<RecordedInputStream*>(self);
+    }
+
+    RecordedInputStream(Recorder& recorder, InputStreamP* inner)
+      : InputStreamP{
+          [](InputStreamP* p) noexcept {
+            const auto self = cast(p);
+            self->record(Call::input_release, [&]() { self->m_inner->release(self->m_inner); });
+            delete self;
+          },
+          [](InputStreamP* p, HostContextP* host) noexcept {
+            const auto self = cast(p);
+            return self->record(Call::input_initialize, [&]() {
+              return self->m_inner->initialize(self->m_inner, host);
+            });
+          },
+          [](InputStreamP* p, ValueSet settings) noexcept {
+            const auto self = cast(p);
+            auto& payload = get_payload();
+            payload.put_value_set(settings);
+            return self->record(Call::input_update_settings, payload, [&]() {
+              return self->m_inner->update_settings(self->m_inner, std::move(settings));
+            });
+          },
+          [](InputStreamP* p, string_view name) noexcept {
+            const auto self = cast(p);
+            auto& payload = get_payload();
+            payload.put_string(name);
+            return self->record(Call::input_get_property, payload, [&]() {
+              return self->m_inner->get_property(self->m_inner, name);
+            });
+          },
+          [](InputStreamP* p, string_view name, string value) noexcept {
+            const auto self = cast(p);
+            auto& payload = get_payload();
+            payload.put_string(name);
+            payload.put_string(value);
+            return self->record(Call::input_set_property, payload, [&]() {
+              return self->m_inner->set_property(self->m_inner, name, std::move(value));
+            });
+          },
+          [](InputStreamP* p) noexcept {
+            const auto self = cast(p);
+            return self->record(Call::input_get_state, [&]() {
+              return self->m_inner->get_state(self->m_inner);
+            });
+          },
+          [](InputStreamP* p) noexcept {
+            const auto self = cast(p);
+            return self->record(Call::input_get_parameter_count, [&]() {
+              return self->m_inner->get_parameter_count(self->m_inner);
+            });
+          },
+          [](InputStreamP* p, size_t index) noexcept -> ParameterP* {
+            const auto self = cast(p);
+            auto& payload = get_payload();
+            payload.put_unsigned(index);
+            return self->record(Call::input_get_parameter, payload, [&]() {
+              return self->get_parameter(index);
+            });
+          },
+          [](InputStreamP* p, bool requested) noexcept {
+            const auto self = cast(p);
+            auto& payload = get_payload();
+            payload.put_bool(requested);
+            self->record(Call::input_set_video_requested, payload, [&]() {
+              self->m_inner->set_video_requested(self->m_inner, requested);
+            });
+          },
+          [](InputStreamP* p, bool requested) noexcept {
+            const auto self = cast(p);
+            auto& payload = get_payload();
+            payload.put_bool(requested);
+            self->record(Call::input_set_audio_requested, payload, [&]() {
+              self->m_inner->set_audio_requested(self->m_inner, requested);
+            });
+          },
+          [](InputStreamP* p) noexcept {
+            const auto self = cast(p);
+            return self->record(Call::input_update, [&]() {
+              return self->m_inner->update(self->m_inner);
+            });
+          },
+          [](InputStreamP* p) noexcept {
+            const auto self = cast(p);
+            return self->record(Call::input_before_render, [&]() {
+              return self->m_inner->before_render(self->m_inner);
+            });
+          },
+          [](InputStreamP* p) noexcept {
+            const auto self = cast(p);
+            return self->record(Call::input_render, [&]() {
+              return self->m_inner->render(self->m_inner);
+            });
+          },
+          [](InputStreamP* p) noexcept {
+            const auto self = cast(p);
+            return self->record(Call::input_after_render, [&]() {
+              return self->m_inner->after_render(self->m_inner);
+            });
+          },
+          [](InputStreamP* p, const ParameterValueUpdate* updates, size_t count) noexcept {
+            const auto self = cast(p);
+            auto& payload = get_payload();
+            payload.put_unsigned(count);
+            for (auto update = updates; update != updates + count; ++update) {
+              payload.put_unsigned(update->parameter_index);
+              put_parameter_value(payload, self->get_parameter_type(update->parameter_index),
+                update->data, update->size);
+            }
+            self->record(Call::input_set_parameter_values, payload, [&]() {
+              self->m_inner->set_parameter_values(self->m_inner, updates, count);
+            });
+          },
+          [](InputStreamP* p, uint64_t* generation, ValueSet* state) noexcept {
+            const auto self = cast(p);
+            auto& payload = get_payload();
+            payload.put_unsigned(*generation);
+            return self->record(Call::input_get_state_if_changed, payload, [&]() {
+              return self->m_inner->get_state_if_changed(self->m_inner, generation, state);
+            });
+          },
+        },
+        RecordedObject(recorder),
+        m_inner(inner) {
+    }
+
+    InputStreamP* inner() const { return m_inner; }
+
+  private:
+    // parameters keep their identity, the host may compare them
+    RecordedParameter* get_parameter(size_t index) {
+      const auto parameter = m_inner->get_parameter(m_inner, index);
+      if (!parameter)
+        return nullptr;
+      const auto lock = std::lock_guard(m_mutex);
+      auto& recorded = m_parameters[parameter];
+      if (!recorded)
+        recorded = std::make_unique<RecordedParameter>(m_recorder, parameter);
+      return recorded.get();
+    }
+
+    ParameterType get_parameter_type(size_t index) const {
+      if (index < m_inner->get_parameter_count(m_inner))
+        if (auto parameter = m_inner->get_parameter(m_inner, index))
+          return parameter->type(parameter);
+      return ParameterType::Data;
+    }
+
+    InputStreamP* const m_inner;
+    std::mutex m_mutex;
+    std::map<ParameterP*, std::unique_ptr<RecordedParameter>> m_parameters;
+  };
+
+  class RecordedOutputStream final : public OutputStreamP, public RecordedObject {
+  public:
+    static RecordedOutputStream* cast(OutputStreamP* self) {
+      return static_cast<RecordedOutputStream*>(self);
+    }
+
+    RecordedOutputStream(Recorder& recorder, OutputStreamP* inner)
+      : OutputStreamP{
+          [](OutputStreamP* p) noexcept {
+            const auto self = cast(p);
+            self->record(Call::output_release, [&]() { self->m_inner->release(self->m_inner); });
+            delete self;
+          },
+          [](OutputStreamP* p, HostContextP* host) noexcept {
+            const auto self = cast(p);
+            return self->record(Call::output_initialize, [&]() {
+              return self->m_inner->initialize(self->m_inner, host);
+            });
+          },
+          [](OutputStreamP* p, ValueSet settings) noexcept {
+            const auto self = cast(p);
+            auto& payload = get_payload();
+            payload.put_value_set(settings);
+            return self->record(Call::output_update_settings, payload, [&]() {
+              return self->m_inner->update_settings(self->m_inner, std::move(settings));
+            });
+          },
+          [](OutputStreamP* p, string_view name) noexcept {
+            const auto self = cast(p);
+            auto& payload = get_payload();
+            payload.put_string(name);
+            return self->record(Call::output_get_property, payload, [&]() {
+              return self->m_inner->get_property(self->m_inner, name);
+            });
+          },
+          [](OutputStreamP* p, string_view name, string value) noexcept {
+            const auto self = cast(p);
+            auto& payload = get_payload();
+            payload.put_string(name);
+            payload.put_string(value);
+            return self->record(Call::output_set_property, payload, [&]() {
+              return self->m_inner->set_property(self->m_inner, name, std::move(value));
+            });
+          },
+          [](OutputStreamP* p) noexcept {
+            const auto self = cast(p);
+            return self->record(Call::output_get_state, [&]() {
+              return self->m_inner->get_state(self->m_inner);
+            });
+          },
+          [](OutputStreamP* p, const AudioFrame* audio_frame, OnComplete on_complete) noexcept {
+            // the samples are not recorded, only the layout of the frame.
+            // the timestamps are not read, frames of 1.2 hosts do not contain them
+            const auto self = cast(p);
+            auto& payload = get_payload();
+            payload.put_unsigned(audio_frame->sample_rate);
+            payload.put_unsigned(audio_frame->channels.size());
+            for (const auto& channel : audio_frame->channels) {
+              payload.put_unsigned(channel.size);
+              payload.put_unsigned(channel.pitch);
+            }
+            self->record(Call::output_send_audio_frame, payload, [&]() {
+              self->m_inner->send_audio_frame(self->m_inner, audio_frame, std::move(on_complete));
+            });
+          },
+          [](OutputStreamP* p) noexcept {
+            const auto self = cast(p);
+            return self->record(Call::output_get_target, [&]() {
+              return self->m_inner->get_target(self->m_inner);
+            });
+          },
+          [](OutputStreamP* p) noexcept {
+            const auto self = cast(p);
+            return self->record(Call::output_before_render, [&]() {
+              return self->m_inner->before_render(self->m_inner);
+            });
+          },
+          [](OutputStreamP* p) noexcept {
+            const auto self = cast(p);
+            return self->record(Call::output_after_render, [&]() {
+              return self->m_inner->after_render(self->m_inner);
+            });
+          },
+          [](OutputStreamP* p) noexcept {
+            const auto self = cast(p);
+            self->record(Call::output_present, [&]() { self->m_inner->present(self->m_inner); });
+          },
+          [](OutputStreamP* p) noexcept {
+            const auto self = cast(p);
+            self->record(Call::output_swap, [&]() { self->m_inner->swap(self->m_inner); });
+          },
+          [](OutputStreamP* p, uint64_t* generation, ValueSet* state) noexcept {
+            const auto self = cast(p);
+            auto& payload = get_payload();
+            payload.put_unsigned(*generation);
+            return self->record(Call::output_get_state_if_changed, payload, [&]() {
+              return self->m_inner->get_state_if_changed(self->m_inner, generation, state);
+            });
+          },
+        },
+        RecordedObject(recorder),
+        m_inner(inner) {
+    }
+
+    OutputStreamP* inner() const { return m_inner; }
+
+  private:
+    OutputStreamP* const m_inner;
+  };
+
+  class RecordedStreamDevice final : public StreamDeviceP, public RecordedObject {
+  public:
+    static RecordedStreamDevice* cast(StreamDeviceP* self) {
+      return static_cast<RecordedStreamDevice*>(self);
+    }
+
+    RecordedStreamDevice(Recorder& recorder, StreamDeviceP* inner)
+      : StreamDeviceP{
+          [](StreamDeviceP* p) noexcept {
+            const auto self = cast(p);
+            self->record(Call::device_release, [&]() { self->m_inner->release(self->m_inner); });
+            delete self;
+          },
+          [](StreamDeviceP* p, HostContextP* host) noexcept {
+            const auto self = cast(p);
+            return self->record(Call::device_initialize, [&]() {
+              return self->m_inner->initialize(self->m_inner, host);
+            });
+          },
+          [](StreamDeviceP* p, ValueSet settings) noexcept {
+            const auto self = cast(p);
+            auto& payload = get_payload();
+            payload.put_value_set(settings);
+            return self->record(Call::device_update_settings, payload, [&]() {
+              return self->m_inner->update_settings(self->m_inner, std::move(settings));
+            });
+          },
+          [](StreamDeviceP* p, string_view name) noexcept {
+            const auto self = cast(p);
+            auto& payload = get_payload();
+            payload.put_string(name);
+            return self->record(Call::device_get_property, payload, [&]() {
+              return self->m_inner->get_property(self->m_inner, name);
+            });
+          },
+          [](StreamDeviceP* p, string_view name, string value) noexcept {
+            const auto self = cast(p);
+            auto& payload = get_payload();
+            payload.put_string(name);
+            payload.put_string(value);
+            return self->record(Call::device_set_property, payload, [&]() {
+              return self->m_inner->set_property(self->m_inner, name, std::move(value));
+            });
+          },
+          [](StreamDeviceP* p) noexcept {
+            const auto self = cast(p);
+            return self->record(Call::device_enumerate_stream_settings, [&]() {
+              return self->m_inner->enumerate_stream_settings(self->m_inner);
+            });
+          },
+          [](StreamDeviceP* p, ValueSet settings) noexcept -> InputStreamP* {
+            const auto self = cast(p);
+            auto& payload = get_payload();
+            payload.put_value_set(settings);
+            return self->record(Call::device_create_input_stream, payload,
+              [&]() -> RecordedInputStream* {
+                const auto stream = self->m_inner->create_input_stream(self->m_inner, std::move(settings));
+                return (stream ? new RecordedInputStream(self->m_recorder, stream) : nullptr);
+              });
+          },
+          [](StreamDeviceP* p, ValueSet settings) noexcept -> OutputStreamP* {
+            const auto self = cast(p);
+            auto& payload = get_payload();
+            payload.put_value_set(settings);
+            return self->record(Call::device_create_output_stream, payload,
+              [&]() -> RecordedOutputStream* {
+                const auto stream = self->m_inner->create_output_stream(self->m_inner, std::move(settings));
+                return (stream ? new RecordedOutputStream(self->m_recorder, stream) : nullptr);
+              });
+          },
+          [](StreamDeviceP* p,
+              InputStreamP* const* input_streams, size_t input_stream_count,
+              OutputStreamP* const* output_streams, size_t output_stream_count) noexcept {
+            const auto self = cast(p);
+            auto& payload = get_payload();
+            auto inputs = std::vector<InputStreamP*>();
+            auto outputs = std::vector<OutputStreamP*>();
+            payload.put_unsigned(input_stream_count);
+            for (auto i = size_t{ }; i < input_stream_count; ++i) {
+              const auto stream = RecordedInputStream::cast(input_streams[i]);
+              payload.put_unsigned(stream->id());
+              inputs.push_back(stream->inner());
+            }
+            payload.put_unsigned(output_stream_count);
+            for (auto i = size_t{ }; i < output_stream_count; ++i) {
+              const auto stream = RecordedOutputStream::cast(output_streams[i]);
+              payload.put_unsigned(stream->id());
+              outputs.push_back(stream->inner());
+            }
+            return self->record(Call::device_set_active_streams, payload, [&]() {
+              return self->m_inner->set_active_streams(self->m_inner,
+                inputs.data(), inputs.size(), outputs.data(), outputs.size());
+            });
+          },
+          [](StreamDeviceP* p) noexcept {
+            const auto self = cast(p);
+            return self->record(Call::device_update, [&]() {
+              return self->m_inner->update(self->m_inner);
+            });
+          },
+          [](StreamDeviceP* p) noexcept {
+            const auto self = cast(p);
+            return self->record(Call::device_before_render, [&]() {
+              return self->m_inner->before_render(self->m_inner);
+            });
+          },
+          [](StreamDeviceP* p) noexcept {
+            const auto self = cast(p);
+            self->record(Call::device_render, [&]() { self->m_inner->render(self->m_inner); });
+          },
+          [](StreamDeviceP* p) noexcept {
+            const auto self = cast(p);
+            return self->record(Call::device_after_render, [&]() {
+              return self->m_inner->after_render(self->m_inner);
+            });
+          },
+          [](StreamDeviceP* p, uint64_t token) noexcept {
+            const auto self = cast(p);
+            auto& payload = get_payload();
+            payload.put_unsigned(token);
+            return self->record(Call::device_enumerate_stream_settings_delta, payload, [&]() {
+              return self->m_inner->enumerate_stream_settings_delta(self->m_inner, token);
+            });
+          },
+        },
+        RecordedObject(recorder),
+        m_inner(inner) {
+    }
+
+  private:
+    StreamDeviceP* const m_inner;
+  };
+
+  class RecordedExtension final : public ExtensionP, public RecordedObject {
+  public:
+    static RecordedExtension* cast(ExtensionP* self) {
+      return static_cast<RecordedExtension*>(self);
+    }
+
+    RecordedExtension(Recorder& recorder, ExtensionP* inner)
+      : ExtensionP{
+          [](ExtensionP* p, HostContextP* host) noexcept {
+            const auto self = cast(p);
+            return self->record(Call::extension_initialize, [&]() {
+              return self->m_inner->initialize(self->m_inner, host);
+            });
+          },
+          [](ExtensionP* p) noexcept {
+            const auto self = cast(p);
+            self->record(Call::extension_shutdown, [&]() { self->m_inner->shutdown(self->m_inner); });
+          },
+          [](ExtensionP* p, string_view name) noexcept {
+            const auto self = cast(p);
+            auto& payload = get_payload();
+            payload.put_string(name);
+            return self->record(Call::extension_get_property, payload, [&]() {
+              return self->m_inner->get_property(self->m_inner, name);
+            });
+          },
+          [](ExtensionP* p, string_view name, string value) noexcept {
+            const auto self = cast(p);
+            auto& payload = get_payload();
+            payload.put_string(name);
+            payload.put_string(value);
+            return self->record(Call::extension_set_property, payload, [&]() {
+              return self->m_inner->set_property(self->m_inner, name, std::move(value));
+            });
+          },
+          [](ExtensionP* p) noexcept {
+            const auto self = cast(p);
+            return self->record(Call::extension_enumerate_stream_device_settings, [&]() {
+              return self->m_inner->enumerate_stream_device_settings(self->m_inner);
+            });
+          },
+          [](ExtensionP* p, ValueSet settings) noexcept -> StreamDeviceP* {
+            const auto self = cast(p);
+            auto& payload = get_payload();
+            payload.put_value_set(settings);
+            return self->record(Call::extension_create_stream_device, payload,
+              [&]() -> RecordedStreamDevice* {
+                const auto device = self->m_inner->create_stream_device(self->m_inner, std::move(settings));
+                return (device ? new RecordedStreamDevice(self->m_recorder, device) : nullptr);
+              });
+          },
+        },
+        RecordedObject(recorder),
+        m_inner(inner) {
+    }
+
+    ExtensionP* close() {
+      record(Call::extension_close, []() { });
+      return m_inner;
+    }
+
+  private:
+    ExtensionP* const m_inner;
+  };
+} // namespace
+
+Recorder::Recorder(const std::filesystem::path& filename)
+  : m_start(Clock::now()),
+    m_writer(filename) {
+}
+
+Recorder::~Recorder() {
+  const auto lock = std::lock_guard(m_mutex);
+  if (!m_writer.flush())
+    ++m_write_errors;
+}
+
+ExtensionP* Recorder::open(ExtensionP* extension) {
+  return (extension ? new RecordedExtension(*this, extension) : nullptr);
+}
+
+ExtensionP* Recorder::close(ExtensionP* extension) {
+  if (!extension)
+    return nullptr;
+  const auto recorded = RecordedExtension::cast(extension);
+  const auto inner = recorded->close();
+  delete recorded;
+
+  const auto lock = std::lock_guard(m_mutex);
+  if (!m_writer.flush())
+    ++m_write_errors;
+  return inner;
+}
+
+void Recorder::write(Call call, uint64_t object, Clock::time_point start,
+    Clock::time_point end, const Encoder& payload) noexcept {
+  const auto lock = std::lock_guard(m_mutex);
+  try {
+    const auto start_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(start - m_start);
+    const auto duration_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
+    m_writer.write(call, object, start_ns.count(), static_cast<uint64_t>(duration_ns.count()), payload);
+    ++m_records_written;
+  }
+  catch (const std::exception&) {
+    ++m_write_errors;
+  }
+}
+
+size_t Recorder::records_written() const {
+  const auto lock = std::lock_guard(m_mutex);
+  return m_records_written;
+}
+
+size_t Recorder::write_errors() const {
+  const auto lock = std::lock_guard(m_mutex);
+  return m_write_errors;
+}
+
+} // namespace
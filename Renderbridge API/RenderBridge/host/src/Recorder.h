@@ -0,0 +1,43 @@
+#pragma once
+
+#include "Recording.h"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+namespace rxext::headless {
+
+// interposes the function tables of an extension and of the objects it creates
+// and writes the calls of the host with arguments, results and durations to a recording
+class Recorder {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  explicit Recorder(const std::filesystem::path& filename);
+  Recorder(const Recorder&) = delete;
+  Recorder& operator=(const Recorder&) = delete;
+  ~Recorder();
+
+  // returns a table, which records the calls and forwards them to extension
+  ExtensionP* open(ExtensionP* extension);
+
+  // records closing and returns the extension passed to open
+  ExtensionP* close(ExtensionP* extension);
+
+  uint64_t next_object_id() { return ++m_last_object_id; }
+  void write(Call call, uint64_t object, Clock::time_point start,
+    Clock::time_point end, const Encoder& payload) noexcept;
+
+  size_t records_written() const;
+  size_t write_errors() const;
+
+private:
+  const Clock::time_point m_start;
+  std::atomic<uint64_t> m_last_object_id{ };
+  mutable std::mutex m_mutex;
+  RecordingWriter m_writer;
+  size_t m_records_written{ };
+  size_t m_write_errors{ };
+};
+
+} // namespace
@@ -0,0 +1,248 @@
+
+#include "Recording.h"
+#include <array>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+
+namespace rxext::headless {
+
+namespace {
+  const auto magic = std::array<uint8_t, 5>{ 'R', 'X', 'R', 'E', 'C' };
+  const auto format_version = uint64_t{ 2 };
+  const auto flush_size = size_t{ 64 * 1024 };
+
+  const char* const call_names[] = {
+    "extension_initialize",
+    "extension_shutdown",
+    "extension_get_property",
+    "extension_set_property",
+    "extension_enumerate_stream_device_settings",
+    "extension_create_stream_device",
+    "extension_close",
+    "device_release",
+    "device_initialize",
+    "device_update_settings",
+    "device_get_property",
+    "device_set_property",
+    "device_enumerate_stream_settings",
+    "device_create_input_stream",
+    "device_create_output_stream",
+    "device_set_active_streams",
+    "device_update",
+    "device_before_render",
+    "device_render",
+    "device_after_render",
+    "device_enumerate_stream_settings_delta",
+    "input_release",
+    "input_initialize",
+    "input_update_settings",
+    "input_get_property",
+    "input_set_property",
+    "input_get_state",
+    "input_get_parameter_count",
+    "input_get_parameter",
+    "input_set_video_requested",
+    "input_set_audio_requested",
+    "input_update",
+    "input_before_render",
+    "input_render",
+    "input_after_render",
+    "input_set_parameter_values",
+    "input_get_state_if_changed",
+    "output_release",
+    "output_initialize",
+    "output_update_settings",
+    "output_get_property",
+    "output_set_property",
+    "output_get_state",
+    "output_send_audio_frame",
+    "output_get_target",
+    "output_before_render",
+    "output_after_render",
+    "output_present",
+    "output_swap",
+    "output_get_state_if_changed",
+    "parameter_type",
+    "parameter_name",
+    "parameter_set_value",
+    "parameter_get_value",
+    "parameter_set_property",
+    "parameter_get_property",
+  };
+  static_assert(std::size(call_names) == static_cast<size_t>(Call::count));
+} // namespace
+
+const char* get_call_name(Call call) {
+  const auto index = static_cast<size_t>(call);
+  return (index < std::size(call_names) ? call_names[index] : "unknown");
+}
+
+void Encoder::put_unsigned(uint64_t value) {
+  while (value >= 0x80) {
+    m_data.push_back(static_cast<uint8_t>(value | 0x80));
+    value >>= 7;
+  }
+  m_data.push_back(static_cast<uint8_t>(value));
+}
+
+void Encoder::put_signed(int64_t value) {
+  // zigzag, so small negative values stay short
+  put_unsigned((static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+}
+
+void Encoder::put_bytes(const void* data, size_t size) {
+  put_unsigned(size);
+  const auto begin = static_cast<const uint8_t*>(data);
+  m_data.insert(m_data.end(), begin, begin + size);
+}
+
+void Encoder::put_value_set(const ValueSet& value_set) {
+  put_unsigned(value_set.values.size());
+  for (const auto& value : value_set.values) {
+    put_string(value.name);
+    put_string(value.value);
+  }
+}
+
+void Encoder::put_texture_desc(const TextureDesc& desc) {
+  put_unsigned(desc.width);
+  put_unsigned(desc.height);
+  put_unsigned(static_cast<uint64_t>(desc.format));
+  put_bool(desc.is_target);
+  put_unsigned(static_cast<uint64_t>(desc.share_handle.type));
+}
+
+uint64_t Decoder::get_unsigned() {
+  auto value = uint64_t{ };
+  for (auto shift = 0; ; shift += 7) {
+    if (m_position == m_end || shift > 63)
+      throw std::runtime_error("recording is truncated");
+    const auto byte = *m_position++;
+    value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+    if (!(byte & 0x80))
+      return value;
+  }
+}
+
+int64_t Decoder::get_signed() {
+  const auto value = get_unsigned();
+  return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+BufferDesc Decoder::get_bytes() {
+  const auto size = get_unsigned();
+  if (size > static_cast<uint64_t>(m_end - m_position))
+    throw std::runtime_error("recording is truncated");
+  const auto data = m_position;
+  m_position += size;
+  return { data, static_cast<size_t>(size), static_cast<size_t>(size) };
+}
+
+string_view Decoder::get_string() {
+  const auto bytes = get_bytes();
+  return { static_cast<const char*>(bytes.data), bytes.size };
+}
+
+ValueSet Decoder::get_value_set() {
+  auto value_set = ValueSet();
+  const auto count = get_unsigned();
+  for (auto i = uint64_t{ }; i < count; ++i) {
+    const auto name = get_string();
+    value_set.values.emplace_back(name, get_string());
+  }
+  return value_set;
+}
+
+TextureDesc Decoder::get_texture_desc() {
+  auto desc = TextureDesc{ };
+  desc.width = static_cast<size_t>(get_unsigned());
+  desc.height = static_cast<size_t>(get_unsigned());
+  desc.format = static_cast<Format>(get_unsigned());
+  desc.is_target = get_bool();
+  desc.share_handle.type = static_cast<HandleType>(get_unsigned());
+  return desc;
+}
+
+RecordingWriter::RecordingWriter(const std::filesystem::path& filename)
+    : m_file(filename, std::ios::binary | std::ios::trunc) {
+  if (!m_file)
+    throw std::runtime_error("opening '" + filename.string() + "' failed");
+  m_buffer.put_bytes(magic.data(), magic.size());
+  m_buffer.put_unsigned(format_version);
+}
+
+RecordingWriter::~RecordingWriter() {
+  flush();
+}
+
+void RecordingWriter::write(Call call, uint64_t object, int64_t start_ns,
+    uint64_t duration_ns, const Encoder& payload) {
+  // records are written when calls returned, so the start times are not monotonic
+  m_buffer.put_unsigned(static_cast<uint64_t>(call));
+  m_buffer.put_unsigned(object);
+  m_buffer.put_signed(start_ns - m_previous_start_ns);
+  m_buffer.put_unsigned(duration_ns);
+  m_buffer.put_bytes(payload.data().data(), payload.data().size());
+  m_previous_start_ns = start_ns;
+  if (m_buffer.data().size() >= flush_size && !flush())
+    throw std::runtime_error("writing recording failed");
+}
+
+bool RecordingWriter::flush() noexcept {
+  const auto& data = m_buffer.data();
+  m_file.write(reinterpret_cast<const char*>(data.data()),
+    static_cast<std::streamsize>(data.size()));
+  m_file.flush();
+  m_buffer.clear();
+  return static_cast<bool>(m_file);
+}
+
+RecordingReader::RecordingReader(const std::filesystem::path& filename) {
+  auto file = std::ifstream(filename, std::ios::binary);
+  if (!file)
+    throw std::runtime_error("opening '" + filename.string() + "' failed");
+  m_data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+  auto header = Decoder(m_data.data(), m_data.data() + m_data.size());
+  const auto file_magic = header.get_bytes();
+  if (file_magic.size != magic.size() || std::memcmp(file_magic.data, magic.data(), magic.size()))
+    throw std::runtime_error("'" + filename.string() + "' is not a recording");
+  if (header.get_unsigned() != format_version)
+    throw std::runtime_error("'" + filename.string() + "' has an unsupported format version");
+  m_records_offset = m_data.size() - header.remaining();
+  rewind();
+}
+
+bool RecordingReader::next(Record& record) {
+  if (m_decoder.at_end())
+    return false;
+  const auto call = m_decoder.get_unsigned();
+  if (call >= static_cast<uint64_t>(Call::count))
+    throw std::runtime_error("recording contains unknown call");
+  try {
+    record.call = static_cast<Call>(call);
+    record.object = m_decoder.get_unsigned();
+    record.start_ns = m_previous_start_ns + m_decoder.get_signed();
+    record.duration_ns = m_decoder.get_unsigned();
+    const auto payload = m_decoder.get_bytes();
+    const auto begin = static_cast<const uint8_t*>(payload.data);
+    record.payload = Decoder(begin, begin + payload.size);
+  }
+  catch (const std::runtime_error&) {
+    // the recording host may have been terminated while writing
+    m_truncated = true;
+    m_decoder = Decoder();
+    return false;
+  }
+  m_previous_start_ns = record.start_ns;
+  return true;
+}
+
+void RecordingReader::rewind() {
+  m_decoder = Decoder(m_data.data() + m_records_offset, m_data.data() + m_data.size());
+  m_previous_start_ns = 0;
+  m_truncated = false;
+}
+
+} // namespace
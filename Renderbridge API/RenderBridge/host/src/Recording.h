@@ -0,0 +1,168 @@
+#pragma once
+
+#include "rxext.h"
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace rxext::headless {
+
+// calls of the host into the function tables of an extension.
+// values are stored in recordings, so only append.
+enum class Call : uint8_t {
+  extension_initialize,
+  extension_shutdown,
+  extension_get_property,
+  extension_set_property,
+  extension_enumerate_stream_device_settings,
+  extension_create_stream_device,
+  extension_close,
+
+  device_release,
+  device_initialize,
+  device_update_settings,
+  device_get_property,
+  device_set_property,
+  device_enumerate_stream_settings,
+  device_create_input_stream,
+  device_create_output_stream,
+  device_set_active_streams,
+  device_update,
+  device_before_render,
+  device_render,
+  device_after_render,
+  device_enumerate_stream_settings_delta,
+
+  input_release,
+  input_initialize,
+  input_update_settings,
+  input_get_property,
+  input_set_property,
+  input_get_state,
+  input_get_parameter_count,
+  input_get_parameter,
+  input_set_video_requested,
+  input_set_audio_requested,
+  input_update,
+  input_before_render,
+  input_render,
+  input_after_render,
+  input_set_parameter_values,
+  input_get_state_if_changed,
+
+  output_release,
+  output_initialize,
+  output_update_settings,
+  output_get_property,
+  output_set_property,
+  output_get_state,
+  output_send_audio_frame,
+  output_get_target,
+  output_before_render,
+  output_after_render,
+  output_present,
+  output_swap,
+  output_get_state_if_changed,
+
+  parameter_type,
+  parameter_name,
+  parameter_set_value,
+  parameter_get_value,
+  parameter_set_property,
+  parameter_get_property,
+
+  count
+};
+
+const char* get_call_name(Call call);
+
+// appends values to a buffer, integers are stored with 7 bits per byte
+class Encoder {
+public:
+  void clear() { m_data.clear(); }
+  const std::vector<uint8_t>& data() const { return m_data; }
+
+  void put_unsigned(uint64_t value);
+  void put_signed(int64_t value);
+  void put_bool(bool value) { put_unsigned(value ? 1 : 0); }
+  void put_bytes(const void* data, size_t size);
+  void put_string(string_view value) { put_bytes(value.data(), value.size()); }
+  void put_value_set(const ValueSet& value_set);
+  void put_texture_desc(const TextureDesc& desc);
+
+private:
+  std::vector<uint8_t> m_data;
+};
+
+// reads the values written by an Encoder, throws when the data is truncated
+class Decoder {
+public:
+  Decoder() = default;
+  Decoder(const uint8_t* begin, const uint8_t* end) : m_position(begin), m_end(end) { }
+
+  bool at_end() const { return m_position == m_end; }
+  size_t remaining() const { return static_cast<size_t>(m_end - m_position); }
+  uint64_t get_unsigned();
+  int64_t get_signed();
+  bool get_bool() { return (get_unsigned() != 0); }
+  BufferDesc get_bytes();
+  string_view get_string();
+  ValueSet get_value_set();
+  TextureDesc get_texture_desc();
+
+private:
+  const uint8_t* m_position{ };
+  const uint8_t* m_end{ };
+};
+
+// a recorded call, payload contains the arguments followed by the result
+struct Record {
+  Call call;
+  uint64_t object;
+  // relative to start of recording
+  int64_t start_ns;
+  uint64_t duration_ns;
+  Decoder payload;
+};
+
+// writes records to a file, which starts with a magic and the format version
+class RecordingWriter {
+public:
+  explicit RecordingWriter(const std::filesystem::path& filename);
+  RecordingWriter(const RecordingWriter&) = delete;
+  RecordingWriter& operator=(const RecordingWriter&) = delete;
+  ~RecordingWriter();
+
+  // throws when writing failed
+  void write(Call call, uint64_t object, int64_t start_ns,
+    uint64_t duration_ns, const Encoder& payload);
+  // returns false when writing failed
+  bool flush() noexcept;
+
+private:
+  std::ofstream m_file;
+  Encoder m_buffer;
+  int64_t m_previous_start_ns{ };
+};
+
+// reads all records of a file into memory
+class RecordingReader {
+public:
+  explicit RecordingReader(const std::filesystem::path& filename);
+
+  // returns false after the last record
+  bool next(Record& record);
+  void rewind();
+  // whether the last record was incomplete
+  bool truncated() const { return m_truncated; }
+
+private:
+  std::vector<uint8_t> m_data;
+  size_t m_records_offset{ };
+  Decoder m_decoder;
+  int64_t m_previous_start_ns{ };
+  bool m_truncated{ };
+};
+
+} // namespace
@@ -0,0 +1,617 @@
+
+#include "Replayer.h"
+#include <memory>
+#include <thread>
+#include <type_traits>
+
+namespace rxext::headless {
+
+namespace {
+  const auto sync_timeout = std::chrono::seconds(1);
+
+  template<typename T>
+  T* find_object(const std::unordered_map<uint64_t, T*>& objects, uint64_t id) {
+    const auto it = objects.find(id);
+    return (it != objects.end() ? it->second : nullptr);
+  }
+
+  bool is_in_range(Call call, Call first, Call last) {
+    return (call >= first && call <= last);
+  }
+
+  CpuTimelineP* get_cpu_timeline(const SyncDesc& sync) {
+    if (sync.sync_strategy != SyncStrategy::CpuTimeline ||
+        sync.share_handle.type != HandleType::RX_CPU_TIMELINE)
+      return nullptr;
+    return static_cast<CpuTimelineP*>(sync.share_handle.handle);
+  }
+
+  // a decoded parameter value, textures are created in the texture buffer
+  struct ParameterValue {
+    ParameterType type;
+    BufferDesc bytes;
+    size_t texture_offset;
+    size_t texture_count;
+  };
+
+  ParameterValue get_parameter_value(Decoder& payload, HostContextP& host,
+      std::vector<TextureP*>& textures) {
+    auto value = ParameterValue{ };
+    value.type = static_cast<ParameterType>(payload.get_unsigned());
+    if (value.type != ParameterType::Texture) {
+      value.bytes = payload.get_bytes();
+      return value;
+    }
+    value.texture_offset = textures.size();
+    value.texture_count = static_cast<size_t>(payload.get_unsigned());
+    for (auto i = size_t{ }; i < value.texture_count; ++i) {
+      auto texture = static_cast<TextureP*>(nullptr);
+      if (payload.get_bool()) {
+        const auto desc = payload.get_texture_desc();
+        texture = host.create_texture(&host, &desc);
+      }
+      textures.push_back(texture);
+    }
+    return value;
+  }
+} // namespace
+
+Replayer::CallStatistics::CallStatistics()
+  : recorded_ms(1e-6, 10000.0, 6),
+    replayed_ms(1e-6, 10000.0, 6) {
+}
+
+Replayer::Replayer(Host& host, const Module& module, const std::filesystem::path& filename)
+  : m_host(host),
+    m_module(module),
+    m_reader(filename) {
+}
+
+Replayer::~Replayer() {
+  shutdown();
+}
+
+void Replayer::run(bool real_time) {
+  m_reader.rewind();
+  const auto start = Clock::now();
+  auto record = Record{ };
+  while (m_reader.next(record)) {
+    const auto record_start = std::chrono::nanoseconds(record.start_ns);
+    if (real_time)
+      std::this_thread::sleep_until(start +
+        std::chrono::duration_cast<Clock::duration>(record_start));
+
+    if (!replay(record)) {
+      ++m_calls_skipped;
+      continue;
+    }
+    ++m_calls_replayed;
+    auto& statistics = m_call_statistics[record.call];
+    statistics.recorded_ms.push(static_cast<double>(record.duration_ns) / 1e6);
+    statistics.replayed_ms.push(
+      std::chrono::duration<double, std::milli>(m_last_call_duration).count());
+    m_recorded_duration = std::max(m_recorded_duration, std::chrono::duration<double>(
+      record_start + std::chrono::nanoseconds(record.duration_ns)));
+  }
+  m_run_duration += Clock::now() - start;
+}
+
+template<typename F>
+auto Replayer::measure(F&& function) {
+  const auto start = Clock::now();
+  if constexpr (std::is_void_v<decltype(function())>) {
+    function();
+    m_last_call_duration = Clock::now() - start;
+  }
+  else {
+    auto result = function();
+    m_last_call_duration = Clock::now() - start;
+    return result;
+  }
+}
+
+template<typename T>
+void Replayer::compare_result(Record& record, const T& result) {
+  if (!record.payload.at_end() &&
+      record.payload.get_unsigned() != static_cast<uint64_t>(result))
+    ++m_results_differing;
+}
+
+bool Replayer::replay(Record& record) {
+  const auto call = record.call;
+  if (is_in_range(call, Call::extension_initialize, Call::extension_close)) {
+    // the module is opened on the first call
+    if (!m_extensions.count(record.object))
+      m_extensions[record.object] = m_module.open();
+    const auto extension = find_object(m_extensions, record.object);
+    return (extension && replay_extension(record, extension));
+  }
+  if (is_in_range(call, Call::device_release, Call::device_enumerate_stream_settings_delta)) {
+    const auto device = find_object(m_devices, record.object);
+    return (device && replay_device(record, device));
+  }
+  if (is_in_range(call, Call::input_release, Call::input_get_state_if_changed)) {
+    const auto stream = find_object(m_inputs, record.object);
+    return (stream && replay_input(record, stream));
+  }
+  if (is_in_range(call, Call::output_release, Call::output_get_state_if_changed)) {
+    const auto stream = find_object(m_outputs, record.object);
+    return (stream && replay_output(record, stream));
+  }
+  const auto parameter = find_object(m_parameters, record.object);
+  return (parameter && replay_parameter(record, parameter));
+}
+
+bool Replayer::replay_extension(Record& record, ExtensionP* extension) {
+  auto& payload = record.payload;
+  switch (record.call) {
+    case Call::extension_initialize: {
+      const auto initialized = measure([&]() { return extension->initialize(extension, &m_host); });
+      compare_result(record, initialized);
+      if (initialized)
+        m_initialized_extensions.insert(record.object);
+      return true;
+    }
+    case Call::extension_shutdown:
+      shutdown_host();
+      measure([&]() { extension->shutdown(extension); });
+      m_initialized_extensions.erase(record.object);
+      return true;
+
+    case Call::extension_get_property: {
+      const auto name = payload.get_string();
+      measure([&]() { return extension->get_property(extension, name); });
+      return true;
+    }
+    case Call::extension_set_property: {
+      const auto name = payload.get_string();
+      auto value = string(payload.get_string());
+      compare_result(record, measure([&]() { return extension->set_property(extension, name, std::move(value)); }));
+      return true;
+    }
+    case Call::extension_enumerate_stream_device_settings:
+      m_host.process_main_thread_callbacks();
+      measure([&]() { return extension->enumerate_stream_device_settings(extension); });
+      return true;
+
+    case Call::extension_create_stream_device: {
+      auto settings = payload.get_value_set();
+      const auto device = measure([&]() {
+        return extension->create_stream_device(extension, std::move(settings));
+      });
+      const auto id = payload.get_unsigned();
+      if (device && id)
+        m_devices[id] = device;
+      m_results_differing += ((id != 0) != (device != nullptr));
+      return true;
+    }
+    case Call::extension_close:
+      measure([&]() { m_module.close(extension); });
+      m_extensions.erase(record.object);
+      return true;
+
+    default:
+      return false;
+  }
+}
+
+bool Replayer::replay_device(Record& record, StreamDeviceP* device) {
+  auto& payload = record.payload;
+  switch (record.call) {
+    case Call::device_release:
+      shutdown_host();
+      measure([&]() { device->release(device); });
+      m_devices.erase(record.object);
+      m_delta_tokens.erase(record.object);
+      return true;
+
+    case Call::device_initialize:
+      compare_result(record, measure([&]() { return device->initialize(device, &m_host); }));
+      return true;
+
+    case Call::device_update_settings: {
+      auto settings = payload.get_value_set();
+      compare_result(record, measure([&]() {
+        return device->update_settings(device, std::move(settings));
+      }));
+      return true;
+    }
+    case Call::device_get_property: {
+      const auto name = payload.get_string();
+      measure([&]() { return device->get_property(device, name); });
+      return true;
+    }
+    case Call::device_set_property: {
+      const auto name = payload.get_string();
+      auto value = string(payload.get_string());
+      compare_result(record, measure([&]() { return device->set_property(device, name, std::move(value)); }));
+      return true;
+    }
+    case Call::device_enumerate_stream_settings:
+      m_host.process_main_thread_callbacks();
+      measure([&]() { return device->enumerate_stream_settings(device); });
+      return true;
+
+    case Call::device_create_input_stream: {
+      auto settings = payload.get_value_set();
+      const auto stream = measure([&]() {
+        return device->create_input_stream(device, std::move(settings));
+      });
+      const auto id = payload.get_unsigned();
+      if (stream && id)
+        m_inputs[id] = stream;
+      m_results_differing += ((id != 0) != (stream != nullptr));
+      return true;
+    }
+    case Call::device_create_output_stream: {
+      auto settings = payload.get_value_set();
+      const auto stream = measure([&]() {
+        return device->create_output_stream(device, std::move(settings));
+      });
+      const auto id = payload.get_unsigned();
+      if (stream && id)
+        m_outputs[id] = stream;
+      m_results_differing += ((id != 0) != (stream != nullptr));
+      return true;
+    }
+    case Call::device_set_active_streams: {
+      auto inputs = std::vector<InputStreamP*>();
+      auto outputs = std::vector<OutputStreamP*>();
+      const auto input_count = payload.get_unsigned();
+      for (auto i = uint64_t{ }; i < input_count; ++i)
+        if (auto stream = find_object(m_inputs, payload.get_unsigned()))
+          inputs.push_back(stream);
+      const auto output_count = payload.get_unsigned();
+      for (auto i = uint64_t{ }; i < output_count; ++i)
+        if (auto stream = find_object(m_outputs, payload.get_unsigned()))
+          outputs.push_back(stream);
+
+      // deactivating all streams precedes destroying them
+      if (!input_count && !output_count)
+        shutdown_host();
+      compare_result(record, measure([&]() {
+        return device->set_active_streams(device,
+          inputs.data(), inputs.size(), outputs.data(), outputs.size());
+      }));
+      return true;
+    }
+    case Call::device_update:
+      m_host.process_main_thread_callbacks();
+      compare_result(record, measure([&]() { return device->update(device); }));
+      return true;
+
+    case Call::device_before_render:
+      measure([&]() { return device->before_render(device); });
+      return true;
+
+    case Call::device_render:
+      measure([&]() { device->render(device); });
+      return true;
+
+    case Call::device_after_render:
+      measure([&]() { return device->after_render(device); });
+      return true;
+
+    case Call::device_enumerate_stream_settings_delta: {
+      // the tokens of the recording are not valid for this device
+      auto& token = m_delta_tokens[record.object];
+      m_host.process_main_thread_callbacks();
+      token = measure([&]() {
+        return device->enumerate_stream_settings_delta(device, token);
+      }).token;
+      return true;
+    }
+    default:
+      return false;
+  }
+}
+
+bool Replayer::replay_input(Record& record, InputStreamP* stream) {
+  auto& payload = record.payload;
+  switch (record.call) {
+    case Call::input_release:
+      measure([&]() { stream->release(stream); });
+      m_inputs.erase(record.object);
+      m_state_generations.erase(record.object);
+      return true;
+
+    case Call::input_initialize:
+      compare_result(record, measure([&]() { return stream->initialize(stream, &m_host); }));
+      return true;
+
+    case Call::input_update_settings: {
+      auto settings = payload.get_value_set();
+      compare_result(record, measure([&]() {
+        return stream->update_settings(stream, std::move(settings));
+      }));
+      return true;
+    }
+    case Call::input_get_property: {
+      const auto name = payload.get_string();
+      measure([&]() { return stream->get_property(stream, name); });
+      return true;
+    }
+    case Call::input_set_property: {
+      const auto name = payload.get_string();
+      auto value = string(payload.get_string());
+      compare_result(record, measure([&]() { return stream->set_property(stream, name, std::move(value)); }));
+      return true;
+    }
+    case Call::input_get_state:
+      measure([&]() { return stream->get_state(stream); });
+      return true;
+
+    case Call::input_get_parameter_count:
+      compare_result(record, measure([&]() { return stream->get_parameter_count(stream); }));
+      return true;
+
+    case Call::input_get_parameter: {
+      const auto index = static_cast<size_t>(payload.get_unsigned());
+      const auto parameter = measure([&]() { return stream->get_parameter(stream, index); });
+      const auto id = payload.get_unsigned();
+      if (parameter && id)
+        m_parameters[id] = parameter;
+      m_results_differing += ((id != 0) != (parameter != nullptr));
+      return true;
+    }
+    case Call::input_set_video_requested: {
+      const auto requested = payload.get_bool();
+      measure([&]() { stream->set_video_requested(stream, requested); });
+      return true;
+    }
+    case Call::input_set_audio_requested: {
+      const auto requested = payload.get_bool();
+      measure([&]() { stream->set_audio_requested(stream, requested); });
+      return true;
+    }
+    case Call::input_update:
+      compare_result(record, measure([&]() { return stream->update(stream); }));
+      return true;
+
+    case Call::input_before_render:
+      wait_sync(measure([&]() { return stream->before_render(stream); }));
+      return true;
+
+    case Call::input_render:
+      compare_result(record, measure([&]() { return stream->render(stream); }));
+      return true;
+
+    case Call::input_after_render:
+      signal_sync(measure([&]() { return stream->after_render(stream); }));
+      return true;
+
+    case Call::input_set_parameter_values: {
+      const auto count = static_cast<size_t>(payload.get_unsigned());
+      auto values = std::vector<std::pair<size_t, ParameterValue>>();
+      m_texture_buffer.clear();
+      for (auto i = size_t{ }; i < count; ++i) {
+        const auto index = static_cast<size_t>(payload.get_unsigned());
+        values.emplace_back(index, get_parameter_value(payload, m_host, m_texture_buffer));
+      }
+      m_updates.clear();
+      for (const auto& [index, value] : values)
+        m_updates.push_back(value.type == ParameterType::Texture ?
+          ParameterValueUpdate{ index, m_texture_buffer.data() + value.texture_offset,
+            value.texture_count * sizeof(TextureP*) } :
+          ParameterValueUpdate{ index, value.bytes.data, value.bytes.size });
+      measure([&]() { stream->set_parameter_values(stream, m_updates.data(), m_updates.size()); });
+      release_textures(m_texture_buffer.data(), m_texture_buffer.size());
+      return true;
+    }
+    case Call::input_get_state_if_changed: {
+      // the generations of the recording are not valid for this stream
+      auto& generation = m_state_generations[record.object];
+      auto state = ValueSet();
+      measure([&]() { return stream->get_state_if_changed(stream, &generation, &state); });
+      return true;
+    }
+    default:
+      return false;
+  }
+}
+
+bool Replayer::replay_output(Record& record, OutputStreamP* stream) {
+  auto& payload = record.payload;
+  switch (record.call) {
+    case Call::output_release:
+      measure([&]() { stream->release(stream); });
+      m_outputs.erase(record.object);
+      m_state_generations.erase(record.object);
+      return true;
+
+    case Call::output_initialize:
+      compare_result(record, measure([&]() { return stream->initialize(stream, &m_host); }));
+      return true;
+
+    case Call::output_update_settings: {
+      auto settings = payload.get_value_set();
+      compare_result(record, measure([&]() {
+        return stream->update_settings(stream, std::move(settings));
+      }));
+      return true;
+    }
+    case Call::output_get_property: {
+      const auto name = payload.get_string();
+      measure([&]() { return stream->get_property(stream, name); });
+      return true;
+    }
+    case Call::output_set_property: {
+      const auto name = payload.get_string();
+      auto value = string(payload.get_string());
+      compare_result(record, measure([&]() { return stream->set_property(stream, name, std::move(value)); }));
+      return true;
+    }
+    case Call::output_get_state:
+      measure([&]() { return stream->get_state(stream); });
+      return true;
+
+    case Call::output_send_audio_frame: {
+      // the samples were not recorded, silence of the same layout is sent
+      auto frame = AudioFrame{ };
+      frame.sample_rate = static_cast<size_t>(payload.get_unsigned());
+      const auto channel_count = static_cast<size_t>(payload.get_unsigned());
+      auto layout = std::vector<std::pair<size_t, size_t>>();
+      auto total_size = size_t{ };
+      for (auto i = size_t{ }; i < channel_count; ++i) {
+        const auto size = static_cast<size_t>(payload.get_unsigned());
+        const auto pitch = static_cast<size_t>(payload.get_unsigned());
+        layout.emplace_back(size, pitch);
+        total_size += size;
+      }
+
+      auto samples = std::make_shared<std::vector<std::byte>>(total_size);
+      auto offset = size_t{ };
+      for (const auto& [size, pitch] : layout) {
+        frame.channels.push_back({ samples->data() + offset, size, pitch });
+        offset += size;
+      }
+      measure([&]() {
+        stream->send_audio_frame(stream, &frame, [samples]() noexcept { });
+      });
+      return true;
+    }
+    case Call::output_get_target: {
+      // target is owned by host
+      const auto target = measure([&]() { return stream->get_target(stream); });
+      if (!record.payload.at_end())
+        m_results_differing += (payload.get_bool() != (target != nullptr));
+      if (target)
+        target->release(target);
+      return true;
+    }
+    case Call::output_before_render:
+      wait_sync(measure([&]() { return stream->before_render(stream); }));
+      return true;
+
+    case Call::output_after_render:
+      signal_sync(measure([&]() { return stream->after_render(stream); }));
+      return true;
+
+    case Call::output_present:
+      measure([&]() { stream->present(stream); });
+      return true;
+
+    case Call::output_swap:
+      measure([&]() { stream->swap(stream); });
+      return true;
+
+    case Call::output_get_state_if_changed: {
+      auto& generation = m_state_generations[record.object];
+      auto state = ValueSet();
+      measure([&]() { return stream->get_state_if_changed(stream, &generation, &state); });
+      return true;
+    }
+    default:
+      return false;
+  }
+}
+
+bool Replayer::replay_parameter(Record& record, ParameterP* parameter) {
+  auto& payload = record.payload;
+  switch (record.call) {
+    case Call::parameter_type:
+      compare_result(record, measure([&]() { return parameter->type(parameter); }));
+      return true;
+
+    case Call::parameter_name:
+      measure([&]() { return parameter->name(parameter); });
+      return true;
+
+    case Call::parameter_set_value: {
+      m_texture_buffer.clear();
+      const auto value = get_parameter_value(payload, m_host, m_texture_buffer);
+      if (value.type == ParameterType::Texture)
+        measure([&]() {
+          parameter->set_value(parameter, m_texture_buffer.data(),
+            m_texture_buffer.size() * sizeof(TextureP*));
+        });
+      else
+        measure([&]() { parameter->set_value(parameter, value.bytes.data, value.bytes.size); });
+      release_textures(m_texture_buffer.data(), m_texture_buffer.size());
+      return true;
+    }
+    case Call::parameter_get_value: {
+      const auto has_data = payload.get_bool();
+      const auto has_size = payload.get_bool();
+      auto size = static_cast<size_t>(payload.get_unsigned());
+      if (!has_data) {
+        measure([&]() { parameter->get_value(parameter, nullptr, (has_size ? &size : nullptr)); });
+        return true;
+      }
+      const auto capacity = size;
+      m_value_buffer.assign(capacity, std::byte{ });
+      measure([&]() { parameter->get_value(parameter, m_value_buffer.data(), &size); });
+
+      // references were acquired for caller, unless the texture count increased
+      if (parameter->type(parameter) == ParameterType::Texture && size <= capacity)
+        release_textures(reinterpret_cast<TextureP* const*>(m_value_buffer.data()),
+          size / sizeof(TextureP*));
+      return true;
+    }
+    case Call::parameter_set_property: {
+      const auto name = payload.get_string();
+      auto value = string(payload.get_string());
+      compare_result(record, measure([&]() { return parameter->set_property(parameter, name, std::move(value)); }));
+      return true;
+    }
+    case Call::parameter_get_property: {
+      const auto name = payload.get_string();
+      measure([&]() { return parameter->get_property(parameter, name); });
+      return true;
+    }
+    default:
+      return false;
+  }
+}
+
+void Replayer::wait_sync(const SyncDesc& sync) {
+  if (auto timeline = get_cpu_timeline(sync)) {
+    const auto timeout_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(sync_timeout);
+    timeline->wait(timeline, sync.value, static_cast<uint64_t>(timeout_ns.count()));
+  }
+}
+
+void Replayer::signal_sync(const SyncDesc& sync) {
+  if (auto timeline = get_cpu_timeline(sync))
+    timeline->signal(timeline, sync.value);
+}
+
+void Replayer::release_textures(TextureP* const* textures, size_t count) {
+  for (auto i = size_t{ }; i < count; ++i)
+    if (auto texture = textures[i])
+      texture->release(texture);
+}
+
+// no more callbacks must be executed while streams are destroyed
+void Replayer::shutdown_host() {
+  if (!m_host_shut_down)
+    m_host.shutdown();
+  m_host_shut_down = true;
+}
+
+// destroys the objects, which were not destroyed when the recording ended
+void Replayer::shutdown() noexcept {
+  shutdown_host();
+  for (const auto& [id, device] : m_devices)
+    device->set_active_streams(device, nullptr, 0, nullptr, 0);
+  for (const auto& [id, stream] : m_outputs)
+    stream->release(stream);
+  m_outputs.clear();
+  for (const auto& [id, stream] : m_inputs)
+    stream->release(stream);
+  m_inputs.clear();
+  m_parameters.clear();
+  for (const auto& [id, device] : m_devices)
+    device->release(device);
+  m_devices.clear();
+  for (const auto& [id, extension] : m_extensions)
+    if (extension) {
+      if (m_initialized_extensions.count(id))
+        extension->shutdown(extension);
+      m_module.close(extension);
+    }
+  m_extensions.clear();
+  m_initialized_extensions.clear();
+}
+
+} // namespace
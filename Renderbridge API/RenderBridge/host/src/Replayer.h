@@ -0,0 +1,93 @@
+#pragma once
+
+#include "Host.h"
+#include "Module.h"
+#include "Recording.h"
+#include "common/statistics.h"
+#include <chrono>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace rxext::headless {
+
+// drives an extension through the calls of a recording. the calls are executed
+// in the recorded order on the calling thread, as fast as possible or at the
+// recorded times, and the host context is replaced by the headless host.
+class Replayer {
+public:
+  struct CallStatistics {
+    CallStatistics();
+    common::Histogram<double> recorded_ms;
+    common::Histogram<double> replayed_ms;
+  };
+
+  Replayer(Host& host, const Module& module, const std::filesystem::path& filename);
+  Replayer(const Replayer&) = delete;
+  Replayer& operator=(const Replayer&) = delete;
+  ~Replayer();
+
+  void run(bool real_time);
+
+  size_t calls_replayed() const { return m_calls_replayed; }
+  // calls on objects, which could not be created
+  size_t calls_skipped() const { return m_calls_skipped; }
+  // calls, which returned a different result than recorded
+  size_t results_differing() const { return m_results_differing; }
+  bool recording_truncated() const { return m_reader.truncated(); }
+  std::chrono::duration<double> recorded_duration() const { return m_recorded_duration; }
+  std::chrono::duration<double> run_duration() const { return m_run_duration; }
+  const std::map<Call, CallStatistics>& call_statistics() const { return m_call_statistics; }
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  template<typename T>
+  using Objects = std::unordered_map<uint64_t, T*>;
+
+  bool replay(Record& record);
+  bool replay_extension(Record& record, ExtensionP* extension);
+  bool replay_device(Record& record, StreamDeviceP* device);
+  bool replay_input(Record& record, InputStreamP* stream);
+  bool replay_output(Record& record, OutputStreamP* stream);
+  bool replay_parameter(Record& record, ParameterP* parameter);
+
+  template<typename F>
+  auto measure(F&& function);
+  template<typename T>
+  void compare_result(Record& record, const T& result);
+  void wait_sync(const SyncDesc& sync);
+  void signal_sync(const SyncDesc& sync);
+  void release_textures(TextureP* const* textures, size_t count);
+  void shutdown_host();
+  void shutdown() noexcept;
+
+  Host& m_host;
+  const Module& m_module;
+  RecordingReader m_reader;
+
+  Objects<ExtensionP> m_extensions;
+  Objects<StreamDeviceP> m_devices;
+  Objects<InputStreamP> m_inputs;
+  Objects<OutputStreamP> m_outputs;
+  Objects<ParameterP> m_parameters;
+  std::unordered_map<uint64_t, uint64_t> m_state_generations;
+  std::unordered_map<uint64_t, uint64_t> m_delta_tokens;
+  std::unordered_set<uint64_t> m_initialized_extensions;
+  bool m_host_shut_down{ };
+
+  std::vector<std::byte> m_value_buffer;
+  std::vector<TextureP*> m_texture_buffer;
+  std::vector<ParameterValueUpdate> m_updates;
+
+  Clock::duration m_last_call_duration{ };
+  size_t m_calls_replayed{ };
+  size_t m_calls_skipped{ };
+  size_t m_results_differing{ };
+  std::chrono::duration<double> m_recorded_duration{ };
+  std::chrono::duration<double> m_run_duration{ };
+  std::map<Call, CallStatistics> m_call_statistics;
+};
+
+} // namespace
@@ -0,0 +1,82 @@
+
+#include "Scheduler.h"
+#include <algorithm>
+#include <tuple>
+
+namespace rxext::headless {
+
+namespace {
+  // orders heap by due time, keeping order of tasks with equal due time
+  template<typename Task>
+  bool is_later(const Task& a, const Task& b) {
+    return std::tie(a.due, a.sequence) > std::tie(b.due, b.sequence);
+  }
+} // namespace
+
+Scheduler::Scheduler(size_t thread_count) {
+  for (auto i = size_t{ }; i < std::max(thread_count, size_t{ 1 }); ++i)
+    m_threads.emplace_back(&Scheduler::thread_func, this);
+}
+
+Scheduler::~Scheduler() {
+  shutdown();
+}
+
+void Scheduler::post(OnComplete callback) {
+  post(Clock::duration::zero(), std::move(callback));
+}
+
+void Scheduler::post(Clock::duration delay, OnComplete callback) {
+  auto lock = std::unique_lock(m_mutex);
+  if (m_shutdown)
+    return;
+  m_tasks.push_back({ Clock::now() + delay, m_sequence++, std::move(callback) });
+  std::push_heap(m_tasks.begin(), m_tasks.end(), is_later<Task>);
+  lock.unlock();
+  m_signal.notify_one();
+}
+
+void Scheduler::shutdown() {
+  auto lock = std::unique_lock(m_mutex);
+  m_shutdown = true;
+  lock.unlock();
+  m_signal.notify_all();
+  for (auto& thread : m_threads)
+    if (thread.joinable())
+      thread.join();
+
+  // destroy callbacks outside of lock, since they may release resources
+  lock.lock();
+  auto tasks = std::move(m_tasks);
+  lock.unlock();
+}
+
+void Scheduler::thread_func() noexcept {
+  auto lock = std::unique_lock(m_mutex);
+  for (;;) {
+    if (m_shutdown)
+      return;
+
+    if (m_tasks.empty()) {
+      m_signal.wait(lock);
+      continue;
+    }
+
+    const auto due = m_tasks.front().due;
+    if (due > Clock::now()) {
+      m_signal.wait_until(lock, due);
+      continue;
+    }
+
+    std::pop_heap(m_tasks.begin(), m_tasks.end(), is_later<Task>);
+    auto callback = std::move(m_tasks.back().callback);
+    m_tasks.pop_back();
+
+    lock.unlock();
+    callback();
+    callback = nullptr;
+    lock.lock();
+  }
+}
+
+} // namespace
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "rxext.h"
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace rxext::headless {
+
+// executes callbacks on a number of worker threads, optionally delayed
+class Scheduler {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  explicit Scheduler(size_t thread_count);
+  Scheduler(const Scheduler&) = delete;
+  Scheduler& operator=(const Scheduler&) = delete;
+  ~Scheduler();
+
+  void post(OnComplete callback);
+  void post(Clock::duration delay, OnComplete callback);
+
+  // stops all threads and discards pending callbacks
+  void shutdown();
+
+private:
+  struct Task {
+    Clock::time_point due;
+    uint64_t sequence;
+    OnComplete callback;
+  };
+
+  void thread_func() noexcept;
+
+  std::mutex m_mutex;
+  std::condition_variable m_signal;
+  std::vector<Task> m_tasks;
+  std::vector<std::thread> m_threads;
+  uint64_t m_sequence{ };
+  bool m_shutdown{ };
+};
+
+} // namespace
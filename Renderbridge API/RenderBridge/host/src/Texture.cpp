@@ -0,0 +1,97 @@
+
+#include "Texture.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace rxext::headless {
+
+namespace {
+  bool is_compatible(const TextureDesc& a, const TextureDesc& b) {
+    return std::tie(a.width, a.height, a.format, a.is_target) ==
+           std::tie(b.width, b.height, b.format, b.is_target);
+  }
+} // namespace
+
+size_t get_bytes_per_pixel(Format format) {
+  switch (format) {
+    case Format::None: break;
+    case Format::R8_UNORM: return 1;
+    case Format::R8G8_UNORM: return 2;
+    case Format::R8G8B8A8_UNORM: return 4;
+    case Format::B8G8R8A8_UNORM: return 4;
+    case Format::R16G16B16A16_SFLOAT: return 8;
+    case Format::R32G32B32A32_SFLOAT: return 16;
+  }
+  return 0;
+}
+
+Texture::Texture(const TextureDesc& desc)
+    : TextureP{
+        [](TextureP* p) noexcept { cast(p)->acquire(); },
+        [](TextureP* p) noexcept { cast(p)->release(); },
+        [](TextureP* p) noexcept { return &cast(p)->m_desc; },
+      },
+      m_desc(desc),
+      m_pitch(desc.width * get_bytes_per_pixel(desc.format)),
+      m_data(m_pitch * desc.height) {
+  if (m_data.empty())
+    throw std::invalid_argument("invalid texture description");
+}
+
+void Texture::write(const BufferDesc& buffer) {
+  const auto src = static_cast<const std::byte*>(buffer.data);
+  if (!src)
+    return;
+  if (buffer.pitch == m_pitch) {
+    std::memcpy(m_data.data(), src, std::min(buffer.size, m_data.size()));
+    return;
+  }
+  const auto row_size = std::min(buffer.pitch, m_pitch);
+  const auto rows = std::min(buffer.pitch ? buffer.size / buffer.pitch : 0, m_desc.height);
+  for (auto y = size_t{ }; y < rows; ++y)
+    std::memcpy(&m_data[y * m_pitch], src + y * buffer.pitch, row_size);
+}
+
+void Texture::acquire() noexcept {
+  m_ref_count.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Texture::release() noexcept {
+  if (m_ref_count.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    // pool is released last, since it may be the last reference to it
+    auto pool = std::move(m_pool);
+    pool->recycle(std::unique_ptr<Texture>(this));
+  }
+}
+
+//-------------------------------------------------------------------------
+
+Texture* TexturePool::create(const TextureDesc& desc) {
+  auto texture = std::unique_ptr<Texture>();
+  {
+    auto lock = std::lock_guard(m_mutex);
+    const auto it = std::find_if(m_free.begin(), m_free.end(),
+      [&](const auto& free) { return is_compatible(free->desc(), desc); });
+    if (it != m_free.end()) {
+      texture = std::move(*it);
+      m_free.erase(it);
+    }
+  }
+  if (!texture) {
+    texture = std::make_unique<Texture>(desc);
+    ++m_textures_allocated;
+  }
+  texture->m_pool = shared_from_this();
+  texture->m_ref_count = 1;
+  ++m_textures_alive;
+  return texture.release();
+}
+
+void TexturePool::recycle(std::unique_ptr<Texture> texture) noexcept {
+  --m_textures_alive;
+  auto lock = std::lock_guard(m_mutex);
+  m_free.push_back(std::move(texture));
+}
+
+} // namespace
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "rxext_util.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
+namespace rxext::headless {
+
+size_t get_bytes_per_pixel(Format format);
+
+class TexturePool;
+
+// a texture in system memory, which is recycled by its pool when released
+class Texture final : public TextureP {
+public:
+  static Texture* cast(TextureP* self) { return static_cast<Texture*>(self); }
+
+  explicit Texture(const TextureDesc& desc);
+  Texture(const Texture&) = delete;
+  Texture& operator=(const Texture&) = delete;
+
+  const TextureDesc& desc() const { return m_desc; }
+  size_t pitch() const { return m_pitch; }
+  size_t size() const { return m_data.size(); }
+  std::byte* data() { return m_data.data(); }
+  const std::byte* data() const { return m_data.data(); }
+  BufferDesc buffer() const { return { m_data.data(), m_data.size(), m_pitch }; }
+  void write(const BufferDesc& buffer);
+
+private:
+  friend class TexturePool;
+
+  void acquire() noexcept;
+  void release() noexcept;
+
+  const TextureDesc m_desc;
+  const size_t m_pitch;
+  std::vector<std::byte> m_data;
+  std::atomic<size_t> m_ref_count{ };
+  std::shared_ptr<TexturePool> m_pool;
+};
+
+class TexturePool final : public std::enable_shared_from_this<TexturePool> {
+public:
+  // returns a texture with a reference count of one
+  Texture* create(const TextureDesc& desc);
+  size_t textures_allocated() const { return m_textures_allocated; }
+  size_t textures_alive() const { return m_textures_alive; }
+
+private:
+  friend class Texture;
+
+  void recycle(std::unique_ptr<Texture> texture) noexcept;
+
+  std::mutex m_mutex;
+  std::vector<std::unique_ptr<Texture>> m_free;
+  std::atomic<size_t> m_textures_allocated{ };
+  std::atomic<size_t> m_textures_alive{ };
+};
+
+} // namespace
@@ -0,0 +1,187 @@
+
+#include "Driver.h"
+#include "Replayer.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+using namespace rxext;
+using namespace rxext::headless;
+
+namespace {
+  const auto usage = R"(usage: RXHeadless <extension> [options]
+
+options:
+  --device <settings>     device settings, e.g. "handle=1,name=Device"
+  --input <settings>      add input stream with settings, e.g. "handle=2"
+  --output <settings>     add output stream with settings, e.g. "handle=Out,resolution_x=3840"
+  --frame-rate <fps>      frames per second, 0 renders as fast as possible (default: 60)
+  --frames <count>        number of frames to render (default: unlimited)
+  --duration <seconds>    time to render (default: 10 when no frame count is set)
+  --workers <count>       number of host worker threads (default: 2)
+  --userdata <path>       directory returned by get_userdata_path (default: temp directory)
+  --audio                 request audio from input streams
+  --no-video              do not request video from input streams
+  --no-cpu-timeline       do not offer CPU timeline synchronization to streams
+  --monitor-phases        let the device and streams publish the durations of their phases
+  --trace <filename>      let the device write a Chrome trace to the userdata directory
+  --record <filename>     record the calls into the extension to a file
+  --replay <filename>     replay the calls of a recording instead of driving streams
+  --real-time             replay the calls at their recorded times, not as fast as possible
+  --log-level <level>     verbose, info, warning or error (default: warning)
+
+without --input and --output the first enumerated stream is opened as input.
+when replaying, the device, stream and frame options are ignored.
+)";
+
+  // parses "key=value,key=value"
+  ValueSet parse_settings(std::string_view string) {
+    auto settings = ValueSet();
+    while (!string.empty()) {
+      const auto end = string.find(',');
+      const auto pair = string.substr(0, end);
+      const auto equal = pair.find('=');
+      if (equal == std::string_view::npos)
+        throw std::invalid_argument("invalid setting '" + std::string(pair) + "'");
+      settings.set(pair.substr(0, equal), std::string(pair.substr(equal + 1)));
+      string = (end == std::string_view::npos ? std::string_view() : string.substr(end + 1));
+    }
+    return settings;
+  }
+
+  EventSeverity parse_log_level(std::string_view level) {
+    if (level == "verbose") return EventSeverity::Verbose;
+    if (level == "info") return EventSeverity::Info;
+    if (level == "warning") return EventSeverity::Warning;
+    if (level == "error") return EventSeverity::Error;
+    throw std::invalid_argument("invalid log level '" + std::string(level) + "'");
+  }
+
+  void print_host_report(const Host& host) {
+    const auto counters = host.counters();
+    const auto mb = [](size_t bytes) { return static_cast<double>(bytes) / (1024.0 * 1024.0); };
+    std::printf("events:                %zu (%zu StreamsChanged, %zu TargetsExhausted)\n",
+      counters.events, counters.streams_changed_events, counters.targets_exhausted_events);
+    std::printf("async callbacks:       %zu\n", counters.async_callbacks);
+    std::printf("textures:              %zu created, %zu allocated, %zu alive\n",
+      counters.textures_created, counters.textures_allocated, counters.textures_alive);
+    std::printf("video frames unpacked: %zu (%.1f MiB)\n",
+      counters.video_frames_unpacked, mb(counters.video_bytes_unpacked));
+    std::printf("downloads:             %zu (%.1f MiB)\n",
+      counters.downloads, mb(counters.download_bytes));
+    std::printf("uploads:               %zu (%.1f MiB)\n",
+      counters.uploads, mb(counters.upload_bytes));
+    std::printf("audio frames:          %zu\n", counters.audio_frames);
+
+    for (const auto& [name, value] : host.monitor_values())
+      std::printf("monitor %-40s %.4f\n", name.c_str(),
+        (value.average && value.count ? value.sum / value.count : value.last));
+  }
+
+  void print_report(const Driver& driver, const Host& host) {
+    const auto seconds = driver.run_duration().count();
+    const auto frames = driver.frames_rendered();
+    const auto& frame_time = driver.frame_time_ms();
+    std::printf("api version:           %s\n", driver.api_version().c_str());
+    std::printf("frames:                %zu\n", frames);
+    std::printf("duration:              %.3f s\n", seconds);
+    std::printf("frame rate:            %.2f fps\n", (seconds > 0 ? frames / seconds : 0.0));
+    std::printf("frame time:            mean %.4f ms, std dev %.4f ms, min %.4f ms, max %.4f ms\n",
+      frame_time.mean(), frame_time.std_dev(),
+      frames ? frame_time.min() : 0.0, frames ? frame_time.max() : 0.0);
+    std::printf("input textures read:   %zu\n", driver.input_textures_read());
+    std::printf("output targets:        %zu (%zu unavailable)\n",
+      driver.output_targets_rendered(), driver.output_targets_unavailable());
+    std::printf("cpu timeline waits:    %zu (%zu timed out)\n",
+      driver.sync_waits(), driver.sync_timeouts());
+    if (auto recorder = driver.recorder())
+      std::printf("calls recorded:        %zu (%zu write errors)\n",
+        recorder->records_written(), recorder->write_errors());
+    print_host_report(host);
+  }
+
+  void print_replay_report(const Replayer& replayer, const Host& host) {
+    std::printf("calls replayed:        %zu (%zu skipped, %zu results differ)\n",
+      replayer.calls_replayed(), replayer.calls_skipped(), replayer.results_differing());
+    if (replayer.recording_truncated())
+      std::printf("recording is truncated, the last call was not replayed\n");
+    std::printf("recorded duration:     %.3f s\n", replayer.recorded_duration().count());
+    std::printf("replay duration:       %.3f s\n", replayer.run_duration().count());
+    print_host_report(host);
+
+    std::printf("\n%-42s %8s %12s %12s %12s %12s\n", "call", "count",
+      "rec mean ms", "rec p99 ms", "mean ms", "p99 ms");
+    for (const auto& [call, statistics] : replayer.call_statistics())
+      std::printf("%-42s %8zu %12.4f %12.4f %12.4f %12.4f\n", get_call_name(call),
+        static_cast<size_t>(statistics.replayed_ms.samples()),
+        statistics.recorded_ms.mean(), statistics.recorded_ms.percentile(99),
+        statistics.replayed_ms.mean(), statistics.replayed_ms.percentile(99));
+  }
+} // namespace
+
+int main(int argc, char* argv[]) try {
+  if (argc < 2 || !std::strcmp(argv[1], "--help")) {
+    std::fputs(usage, stderr);
+    return (argc < 2 ? EXIT_FAILURE : EXIT_SUCCESS);
+  }
+
+  const auto filename = std::string(argv[1]);
+  auto host_settings = Host::Settings{ };
+  host_settings.userdata_path = std::filesystem::temp_directory_path() / "RXHeadless";
+  auto driver_settings = Driver::Settings{ };
+  auto frame_rate = 60.0;
+  auto frame_count = size_t{ };
+  auto duration = std::chrono::duration<double>{ };
+  auto replay_file = std::filesystem::path();
+  auto real_time = false;
+
+  for (auto i = 2; i < argc; ++i) {
+    const auto option = std::string_view(argv[i]);
+    const auto argument = [&]() {
+      if (i + 1 >= argc)
+        throw std::invalid_argument("missing argument for '" + std::string(option) + "'");
+      return std::string_view(argv[++i]);
+    };
+    if (option == "--device") driver_settings.device_settings = parse_settings(argument());
+    else if (option == "--input") driver_settings.input_settings.push_back(parse_settings(argument()));
+    else if (option == "--output") driver_settings.output_settings.push_back(parse_settings(argument()));
+    else if (option == "--frame-rate") frame_rate = std::stod(std::string(argument()));
+    else if (option == "--frames") frame_count = std::stoul(std::string(argument()));
+    else if (option == "--duration") duration = std::chrono::duration<double>(std::stod(std::string(argument())));
+    else if (option == "--workers") host_settings.worker_count = std::stoul(std::string(argument()));
+    else if (option == "--userdata") host_settings.userdata_path = std::string(argument());
+    else if (option == "--audio") driver_settings.audio_requested = true;
+    else if (option == "--no-video") driver_settings.video_requested = false;
+    else if (option == "--no-cpu-timeline") driver_settings.cpu_timeline = false;
+    else if (option == "--monitor-phases") driver_settings.monitor_phases = true;
+    else if (option == "--trace") driver_settings.trace_file = std::string(argument());
+    else if (option == "--record") driver_settings.record_file = std::string(argument());
+    else if (option == "--replay") replay_file = std::string(argument());
+    else if (option == "--real-time") real_time = true;
+    else if (option == "--log-level") host_settings.log_level = parse_log_level(argument());
+    else throw std::invalid_argument("unknown option '" + std::string(option) + "'");
+  }
+  if (!frame_count && !duration.count())
+    duration = std::chrono::duration<double>(10.0);
+
+  const auto module = Module(filename);
+  auto host = Host(std::move(host_settings));
+  if (!replay_file.empty()) {
+    auto replayer = Replayer(host, module, replay_file);
+    replayer.run(real_time);
+    print_replay_report(replayer, host);
+    return EXIT_SUCCESS;
+  }
+  {
+    auto driver = Driver(host, module, std::move(driver_settings));
+    driver.run(frame_rate, frame_count, duration);
+    print_report(driver, host);
+  }
+  return EXIT_SUCCESS;
+}
+catch (const std::exception& ex) {
+  std::fprintf(stderr, "%s\n", ex.what());
+  return EXIT_FAILURE;
+}
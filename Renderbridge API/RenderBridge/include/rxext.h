@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
 #pragma push_macro("new")
 #undef new
 #include <iostream>
@@ -11,7 +12,7 @@
 
 namespace rxext {
 
-constexpr const char* api_version = "1.2";
+constexpr const char* api_version = "1.3";
 
 template<typename T> 
 using vector = ptl::vector<T>;
@@ -61,6 +62,8 @@ enum class EventCategory : size_t {
   DevicesChanged = 4,
   Failed         = 11,
   StreamsChanged = 12,
+  // since 1.3
+  TargetsExhausted = 13,
 };
 
 enum class ParameterType : size_t {
@@ -84,6 +87,8 @@ enum class HandleType : size_t {
   D3D11_IMAGE_KMT  = 0x958C,
   D3D_FENCE        = 0x9594,
   RX_TEXTURE       = 1,
+  // since 1.3
+  RX_CPU_TIMELINE  = 2,
 };
 
 struct ShareHandle {
@@ -129,6 +134,8 @@ enum class SyncStrategy {
   None,
   BinarySemaphore,
   TimelineSemaphore,
+  // since 1.3
+  CpuTimeline,
 };
 
 struct SyncDesc {
@@ -143,16 +150,51 @@ struct BufferDesc {
   size_t pitch;
 };
 
+// zero when unknown, capture time is in nanoseconds of std::chrono::steady_clock,
+// presentation time is in nanoseconds of the stream's time base
+struct FrameTimestamps {
+  int64_t capture_time_ns;
+  int64_t presentation_time_ns;
+};
+
 struct VideoFrame {
   size_t resolution_x;
   size_t resolution_y;
   string pixel_format;
   vector<BufferDesc> planes;
+  // since 1.3
+  FrameTimestamps timestamps;
 };
 
 struct AudioFrame {
   size_t sample_rate;
   vector<BufferDesc> channels;
+  // since 1.3, extensions must not read it from frames created by the host
+  FrameTimestamps timestamps;
+};
+
+// changes of the enumerated stream settings since a token, streams are identified 
+// by their handle. when full is set, added contains all streams.
+struct StreamSettingsDelta {
+  uint64_t token;
+  bool full;
+  vector<ValueSet> added;
+  vector<ValueSet> changed;
+  vector<string> removed;
+};
+
+struct ParameterValueUpdate {
+  size_t parameter_index;
+  const void* data;
+  size_t size;
+};
+
+// counter in process memory, which threads can wait on to reach a value.
+// it is the handle of a ShareHandle of type RX_CPU_TIMELINE.
+struct CpuTimelineP {
+  uint64_t (*get_value)(CpuTimelineP* p) noexcept;
+  void (*signal)(CpuTimelineP* p, uint64_t value) noexcept;
+  bool (*wait)(CpuTimelineP* p, uint64_t value, uint64_t timeout_ns) noexcept;
 };
 
 struct TextureP {
@@ -200,6 +242,9 @@ struct InputStreamP {
   SyncDesc (*before_render)(InputStreamP* p) noexcept;
   RenderResult (*render)(InputStreamP* p) noexcept;
   SyncDesc (*after_render)(InputStreamP* p) noexcept;
+  // since 1.3
+  void (*set_parameter_values)(InputStreamP* p, const ParameterValueUpdate* updates, size_t count) noexcept;
+  bool (*get_state_if_changed)(InputStreamP* p, uint64_t* generation, ValueSet* state) noexcept;
 };
 
 struct OutputStreamP {
@@ -215,6 +260,8 @@ struct OutputStreamP {
   SyncDesc (*after_render)(OutputStreamP* p) noexcept;
   void (*present)(OutputStreamP* p) noexcept;
   void (*swap)(OutputStreamP* p) noexcept;
+  // since 1.3
+  bool (*get_state_if_changed)(OutputStreamP* p, uint64_t* generation, ValueSet* state) noexcept;
 };
 
 struct StreamDeviceP {
@@ -233,6 +280,8 @@ struct StreamDeviceP {
   SyncDesc (*before_render)(StreamDeviceP* p) noexcept;
   void (*render)(StreamDeviceP* p) noexcept;
   SyncDesc (*after_render)(StreamDeviceP* p) noexcept;
+  // since 1.3
+  StreamSettingsDelta (*enumerate_stream_settings_delta)(StreamDeviceP* p, uint64_t token) noexcept;
 };
 
 struct ExtensionP {
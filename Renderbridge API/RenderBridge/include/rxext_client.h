@@ -1,14 +1,39 @@
 #pragma once
 
 #include "rxext_util.h"
+#include "common/statistics.h"
 #include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <limits>
 #include <mutex>
 #include <map>
+#include <memory>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+
+#if defined(__linux__)
+#  include <climits>
+#  include <ctime>
+#  include <linux/futex.h>
+#  include <sys/syscall.h>
+#  include <unistd.h>
+#endif
 
 namespace rxext {
 
 using SendVideoFrame = function<void(const VideoFrame&, OnComplete) noexcept>;
 using SendAudioFrame = function<void(const AudioFrame&, OnComplete) noexcept>;
+
+class InputStream;
+class StreamDevice;
+inline const std::string* intern_string(string_view string);
   
 class Parameter : public ParameterP {
 public:
@@ -31,13 +56,275 @@ public:
   virtual void get_value(void* data, size_t* size) const noexcept = 0;
   virtual bool set_property(string_view name, string value) noexcept { return false; }
   virtual string get_property(string_view name) const noexcept { return { }; }
+  // incremented whenever the value changes, zero when changes are not tracked
+  virtual uint64_t generation() const noexcept { return 0; }
+  // size set_value expects, zero when values of any size are accepted
+  virtual size_t value_size() const noexcept { return 0; }
 
   template<typename T>
   bool set_property(string_view name, T&& value) noexcept { 
     return set_property(name, value_to_string(std::forward<T>(value)));
   }
+
+protected:
+  // to be called after a property changed, invalidates the index of the owning stream
+  void property_changed() noexcept {
+    if (m_property_changes)
+      m_property_changes->fetch_add(1, std::memory_order_relaxed);
+  }
+
+private:
+  friend class InputStream;
+  std::atomic<uint64_t>* m_property_changes{ };
+};
+
+// records trace events in a buffer per thread while it is enabled, which can be
+// written as Chrome trace JSON, to be viewed in chrome://tracing or ui.perfetto.dev.
+// recording is lock-free, except for registering the buffer of a new thread.
+// names and scopes need to stay valid until the events were written.
+class Tracer {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  static Tracer& instance() {
+    static auto tracer = Tracer();
+    return tracer;
+  }
+
+  Tracer() = default;
+  Tracer(const Tracer&) = delete;
+  Tracer& operator=(const Tracer&) = delete;
+
+  // checked by every recording function, without initializing the instance
+  static bool enabled() noexcept { return s_enabled.load(std::memory_order_relaxed); }
+
+  // tracing is enabled while start was called more often than stop,
+  // only the events since it was enabled last are written
+  void start() {
+    auto lock = std::lock_guard(m_mutex);
+    if (!m_sessions++) {
+      // no trace is being written, so the buffers can be refilled from the start
+      for (auto& buffer : m_buffers)
+        buffer->reset();
+      m_session_start = Clock::now();
+      s_enabled.store(true, std::memory_order_relaxed);
+    }
+  }
+
+  void stop() {
+    auto lock = std::lock_guard(m_mutex);
+    if (m_sessions && !--m_sessions)
+      s_enabled.store(false, std::memory_order_relaxed);
+  }
+
+  void begin(const char* name, const char* scope = nullptr) noexcept {
+    if (enabled())
+      record('B', name, scope, 0);
+  }
+
+  // ends a slice, which was begun while tracing was enabled
+  void end(const char* name, const char* scope = nullptr) noexcept {
+    record('E', name, scope, 0);
+  }
+
+  // returns the id of a flow from a request to its completion, zero when disabled
+  uint64_t flow_begin(const char* name) noexcept {
+    if (!enabled())
+      return 0;
+    const auto id = m_next_flow_id.fetch_add(1, std::memory_order_relaxed) + 1;
+    record('s', name, nullptr, id);
+    return id;
+  }
+
+  // binds the end of a flow to the enclosing slice
+  void flow_end(const char* name, uint64_t id) noexcept {
+    if (id)
+      record('f', name, nullptr, id);
+  }
+
+  uint64_t events_dropped() const {
+    auto lock = std::lock_guard(m_mutex);
+    auto dropped = uint64_t{ };
+    for (const auto& buffer : m_buffers)
+      dropped += buffer->dropped.load(std::memory_order_relaxed);
+    return dropped;
+  }
+
+  void write_chrome_json(std::ostream& os) const {
+    auto lock = std::lock_guard(m_mutex);
+    const auto session_start = m_session_start;
+    auto separator = [&, first = true]() mutable { os << (first ? "\n" : ",\n"); first = false; };
+    os << "{\"traceEvents\":[";
+    auto dropped = uint64_t{ };
+    for (const auto& buffer : m_buffers) {
+      separator();
+      os << R"({"name":"thread_name","ph":"M","pid":1,"tid":)" << buffer->thread_index 
+         << R"(,"args":{"name":"thread )" << buffer->thread_index << "\"}}";
+      buffer->for_each([&](const Event& event) {
+        if (event.time < session_start)
+          return;
+        separator();
+        os << "{\"name\":";
+        write_string(os, event.name);
+        os << ",\"cat\":";
+        write_string(os, event.scope ? event.scope : (event.id ? "flow" : "rxext"));
+        os << ",\"ph\":\"" << event.phase << "\",\"ts\":" 
+           << std::chrono::duration<double, std::micro>(event.time - session_start).count()
+           << ",\"pid\":1,\"tid\":" << buffer->thread_index;
+        if (event.id)
+          os << ",\"id\":" << event.id;
+        if (event.phase == 'f')
+          os << ",\"bp\":\"e\"";
+        os << "}";
+      });
+      dropped += buffer->dropped.load(std::memory_order_relaxed);
+    }
+    os << "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"events_dropped\":\"" << dropped << "\"}}\n";
+  }
+
+  bool write_chrome_json(const std::string& filename) const {
+    auto file = std::ofstream(filename, std::ios::binary);
+    write_chrome_json(file);
+    return file.good();
+  }
+
+private:
+  struct Event {
+    Clock::time_point time;
+    const char* name;
+    const char* scope;
+    uint64_t id;
+    char phase;
+  };
+
+  // appended by its thread only, while the writer reads the published events
+  struct ThreadBuffer {
+    static constexpr size_t chunk_size = 4096;
+    static constexpr size_t max_chunks = 256;
+    using Chunk = std::array<Event, chunk_size>;
+
+    explicit ThreadBuffer(size_t thread_index) : thread_index(thread_index) { }
+    ~ThreadBuffer() {
+      for (auto& chunk : chunks)
+        delete chunk.load(std::memory_order_relaxed);
+    }
+
+    void push(const Event& event) noexcept {
+      const auto index = count.load(std::memory_order_relaxed);
+      const auto chunk_index = index / chunk_size;
+      auto chunk = (chunk_index < max_chunks ? 
+        chunks[chunk_index].load(std::memory_order_relaxed) : nullptr);
+      if (!chunk && chunk_index < max_chunks) {
+        chunk = new (std::nothrow) Chunk();
+        chunks[chunk_index].store(chunk, std::memory_order_release);
+      }
+      if (!chunk) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+      }
+      (*chunk)[index % chunk_size] = event;
+      count.store(index + 1, std::memory_order_release);
+    }
+
+    // chunks are kept, an event still pushed by its thread after the reset
+    // may restore the previous count, but older events are filtered by time
+    void reset() noexcept {
+      count.store(0, std::memory_order_relaxed);
+      dropped.store(0, std::memory_order_relaxed);
+    }
+
+    template<typename F>
+    void for_each(F&& function) const {
+      const auto size = count.load(std::memory_order_acquire);
+      for (auto i = size_t{ }; i < size; ++i)
+        function((*chunks[i / chunk_size].load(std::memory_order_acquire))[i % chunk_size]);
+    }
+
+    const size_t thread_index;
+    std::array<std::atomic<Chunk*>, max_chunks> chunks{ };
+    std::atomic<size_t> count{ };
+    std::atomic<uint64_t> dropped{ };
+  };
+
+  static void write_string(std::ostream& os, const char* string) {
+    os << '"';
+    for (; *string; ++string) {
+      const auto c = *string;
+      if (c == '"' || c == '\\')
+        os << '\\' << c;
+      else if (static_cast<unsigned char>(c) < 0x20)
+        os << ' ';
+      else
+        os << c;
+    }
+    os << '"';
+  }
+
+  ThreadBuffer* thread_buffer() noexcept {
+    static thread_local auto buffer = static_cast<ThreadBuffer*>(nullptr);
+    if (!buffer) try {
+      auto lock = std::lock_guard(m_mutex);
+      buffer = m_buffers.emplace_back(
+        std::make_unique<ThreadBuffer>(m_buffers.size())).get();
+    }
+    catch (...) {
+      return nullptr;
+    }
+    return buffer;
+  }
+
+  void record(char phase, const char* name, const char* scope, uint64_t id) noexcept {
+    if (auto buffer = thread_buffer())
+      buffer->push({ Clock::now(), name, scope, id, phase });
+  }
+
+  static inline std::atomic<bool> s_enabled{ };
+  mutable std::mutex m_mutex;
+  size_t m_sessions{ };
+  Clock::time_point m_session_start{ };
+  std::atomic<uint64_t> m_next_flow_id{ };
+  std::vector<std::unique_ptr<ThreadBuffer>> m_buffers;
+};
+
+// records a slice from its construction to its destruction, when tracing is enabled
+class TraceSlice {
+public:
+  explicit TraceSlice(const char* name, const char* scope = nullptr) noexcept {
+    if (Tracer::enabled()) {
+      m_name = name;
+      m_scope = scope;
+      Tracer::instance().begin(name, scope);
+    }
+  }
+  TraceSlice(const TraceSlice&) = delete;
+  TraceSlice& operator=(const TraceSlice&) = delete;
+  ~TraceSlice() {
+    if (m_name)
+      Tracer::instance().end(m_name, m_scope);
+  }
+
+private:
+  const char* m_name{ };
+  const char* m_scope{ };
 };
 
+namespace detail {
+  // links a request to its callback with a flow event and records the callback as slice
+  template<typename Callback>
+  Callback trace_callback(const char* name, Callback&& callback) {
+    const auto flow = (Tracer::enabled() ? Tracer::instance().flow_begin(name) : 0);
+    if (!flow)
+      return std::move(callback);
+    return [callback = std::move(callback), name, flow](auto&&... args) mutable noexcept {
+      auto& tracer = Tracer::instance();
+      tracer.begin(name, "callback");
+      tracer.flow_end(name, flow);
+      callback(std::forward<decltype(args)>(args)...);
+      tracer.end(name, "callback");
+    };
+  }
+} // namespace
+
 class HostContext final {
 public:
   HostContext() = default;
@@ -79,14 +366,20 @@ public:
     return TextureRef(p->create_texture(p, &desc));
   }
   void download_texture(TextureRef texture, OnTextureDownloaded callback) noexcept {
-    p->download_texture(p, texture.release(), std::move(callback)); 
+    const auto slice = TraceSlice("download_texture");
+    p->download_texture(p, texture.release(), 
+      detail::trace_callback("download_texture", std::move(callback))); 
   }
   void upload_texture(TextureRef texture, const BufferDesc& buffer, bool upload_copy, OnComplete callback) noexcept {
-    p->upload_texture(p, texture.release(), &buffer, upload_copy, std::move(callback));
+    const auto slice = TraceSlice("upload_texture");
+    p->upload_texture(p, texture.release(), &buffer, upload_copy, 
+      detail::trace_callback("upload_texture", std::move(callback)));
   }
   void unpack_video_frame(const VideoFrame& frame, OnComplete on_data_read, OnVideoFrameUnpacked on_unpacked) noexcept {
+    const auto slice = TraceSlice("unpack_video_frame");
     p->unpack_video_frame(p, &frame, std::move(on_data_read), 
-      [on_unpacked = std::move(on_unpacked)](TextureP** textures, size_t texture_count) mutable noexcept {
+      [on_unpacked = detail::trace_callback("unpack_video_frame", std::move(on_unpacked))](
+          TextureP** textures, size_t texture_count) mutable noexcept {
         on_unpacked({ textures, textures + texture_count });
       });
   }
@@ -101,6 +394,275 @@ private:
   HostContextP* p{ };
 };
 
+// aggregates measurements and publishes them with HostContext::monitor_value,
+// at most once per publish interval. values are published as exponential moving
+// average, optionally with percentiles of the interval, counters as sum. 
+// it is not thread safe.
+class Monitor {
+public:
+  using Clock = std::chrono::steady_clock;
+  using Index = size_t;
+
+  // measures the milliseconds until it is destroyed, does nothing without a monitor
+  class ScopedTimer {
+  public:
+    ScopedTimer() = default;
+    ScopedTimer(Monitor* monitor, Index index) noexcept
+      : m_monitor(monitor), m_index(index) {
+      if (m_monitor)
+        m_start = Clock::now();
+    }
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+    ~ScopedTimer() {
+      if (m_monitor) {
+        const auto now = Clock::now();
+        m_monitor->push(m_index, 
+          std::chrono::duration<double, std::milli>(now - m_start).count(), now);
+      }
+    }
+
+  private:
+    Monitor* m_monitor{ };
+    Index m_index{ };
+    Clock::time_point m_start;
+  };
+
+  // names are prefixed with "<prefix>.", the host needs to outlive the monitor
+  Monitor(HostContext& host, string prefix, 
+      std::chrono::duration<double> publish_interval = std::chrono::milliseconds(500),
+      double weight = 0.1)
+    : m_host(&host), m_prefix(std::move(prefix)), 
+      m_publish_interval(std::chrono::duration_cast<Clock::duration>(publish_interval)),
+      m_weight(weight), m_next_publish(Clock::now() + m_publish_interval) { }
+
+  // values with percentiles are also published as "<name>.p50", "<name>.p99" and 
+  // "<name>.p99_9" of the samples since the previous publication. they are recorded
+  // in a histogram from 0.0001 to 10000 with a relative error of at most 1/64
+  Index add_value(string_view name, bool percentiles = false) { 
+    const auto index = add(name, false); 
+    if (percentiles) {
+      auto& entry = m_entries[index];
+      entry.histogram = create_histogram();
+      for (auto i = size_t{ }; i < published_percentiles.size(); ++i)
+        entry.percentile_names[i] = entry.name + published_percentiles[i].suffix;
+      if (!m_snapshot)
+        m_snapshot = create_histogram();
+    }
+    return index;
+  }
+  Index add_counter(string_view name) { return add(name, true); }
+  const string& name(Index index) const { return m_entries[index].name; }
+
+  ScopedTimer measure(Index index) noexcept { return ScopedTimer(this, index); }
+
+  void push(Index index, double value, Clock::time_point now = Clock::now()) noexcept {
+    auto& entry = m_entries[index];
+    if (!entry.samples++)
+      entry.statistic.reset(value);
+    else
+      entry.statistic.push(value);
+    if (entry.histogram)
+      entry.histogram->push(value);
+    publish_if_due(now);
+  }
+
+  void count(Index index, double increment = 1) noexcept {
+    auto& entry = m_entries[index];
+    ++entry.samples;
+    entry.sum += increment;
+    publish_if_due(Clock::now());
+  }
+
+  double mean(Index index) const noexcept { return m_entries[index].statistic.mean(); }
+  double sum(Index index) const noexcept { return m_entries[index].sum; }
+
+  // publishes the entries, which received samples
+  void publish() noexcept {
+    if (!*m_host)
+      return;
+    for (auto& entry : m_entries) {
+      if (entry.samples)
+        m_host->monitor_value(entry.name.c_str(),
+          (entry.counter ? entry.sum : entry.statistic.mean()), false);
+      if (entry.histogram && entry.histogram->samples()) {
+        entry.histogram->take_snapshot(*m_snapshot);
+        for (auto i = size_t{ }; i < published_percentiles.size(); ++i)
+          m_host->monitor_value(entry.percentile_names[i].c_str(),
+            m_snapshot->percentile(published_percentiles[i].percentile), false);
+      }
+    }
+  }
+
+private:
+  using Histogram = common::Histogram<double>;
+
+  struct Percentile {
+    double percentile;
+    const char* suffix;
+  };
+  static constexpr std::array<Percentile, 3> published_percentiles{ { 
+    { 50, ".p50" }, { 99, ".p99" }, { 99.9, ".p99_9" } } };
+
+  struct Entry {
+    string name;
+    bool counter;
+    common::ExponentialStatistic<double> statistic;
+    uint64_t samples;
+    double sum;
+    std::unique_ptr<Histogram> histogram;
+    std::array<string, published_percentiles.size()> percentile_names;
+  };
+
+  static std::unique_ptr<Histogram> create_histogram() {
+    return std::make_unique<Histogram>(0.0001, 10000.0, 6);
+  }
+
+  Index add(string_view name, bool counter) {
+    m_entries.push_back({ m_prefix + "." + string(name), counter, 
+      common::ExponentialStatistic<double>(0.0, m_weight), 0, 0.0, nullptr, { } });
+    return m_entries.size() - 1;
+  }
+
+  void publish_if_due(Clock::time_point now) noexcept {
+    if (now < m_next_publish)
+      return;
+    m_next_publish = now + m_publish_interval;
+    publish();
+  }
+
+  HostContext* m_host;
+  string m_prefix;
+  Clock::duration m_publish_interval;
+  double m_weight;
+  Clock::time_point m_next_publish;
+  std::vector<Entry> m_entries;
+  std::unique_ptr<Histogram> m_snapshot;
+};
+
+namespace detail {
+  // the phases of streams and devices, which are timed by their thunks
+  enum class Phase : size_t { update, before_render, render, after_render, present, swap };
+  inline constexpr const char* phase_names[] = { 
+    "update", "before_render", "render", "after_render", "present", "swap" };
+
+  inline std::unique_ptr<Monitor> create_phase_monitor(HostContext& host, string prefix) {
+    auto monitor = std::make_unique<Monitor>(host, std::move(prefix));
+    for (auto name : phase_names)
+      monitor->add_value(std::string(name) + "_ms", true);
+    return monitor;
+  }
+
+  // times a phase and records it as trace slice, when enabled
+  class PhaseScope {
+  public:
+    PhaseScope(Monitor* monitor, const char* trace_scope, Phase phase) noexcept {
+      if (monitor || Tracer::enabled())
+        begin(monitor, trace_scope, phase);
+    }
+    PhaseScope(const PhaseScope&) = delete;
+    PhaseScope& operator=(const PhaseScope&) = delete;
+    ~PhaseScope() {
+      if (m_phase)
+        end();
+    }
+
+  private:
+    void begin(Monitor* monitor, const char* trace_scope, Phase phase) noexcept {
+      m_monitor = monitor;
+      m_phase = phase_names[static_cast<size_t>(phase)];
+      m_index = static_cast<Monitor::Index>(phase);
+      if (Tracer::enabled()) {
+        m_trace_scope = trace_scope;
+        Tracer::instance().begin(m_phase, trace_scope);
+      }
+      if (m_monitor)
+        m_start = Monitor::Clock::now();
+    }
+
+    void end() noexcept {
+      if (m_monitor) {
+        const auto now = Monitor::Clock::now();
+        m_monitor->push(m_index, 
+          std::chrono::duration<double, std::milli>(now - m_start).count(), now);
+      }
+      if (m_trace_scope)
+        Tracer::instance().end(m_phase, m_trace_scope);
+    }
+
+    const char* m_phase{ };
+    Monitor* m_monitor{ };
+    Monitor::Index m_index{ };
+    const char* m_trace_scope{ };
+    Monitor::Clock::time_point m_start;
+  };
+
+  // applies the settings of new devices and streams, which are handled by the client library
+  class InstanceSettings {
+  public:
+    InstanceSettings(string_view kind, const ValueSet& settings)
+      : m_monitor_id(settings.get(SettingNames::monitor_id, "")),
+        m_trace_file(settings.get(SettingNames::trace_file, "")) {
+      const auto id = (!m_monitor_id.empty() ? m_monitor_id : 
+        settings.get(SettingNames::handle, ""));
+      m_trace_scope = intern_string(std::string(kind) + 
+        (id.empty() ? "" : "." + id))->c_str();
+    }
+
+    template<typename T>
+    T* apply(T* instance) {
+      if (!instance)
+        return nullptr;
+      instance->m_trace_scope = m_trace_scope;
+      if (!m_monitor_id.empty())
+        instance->enable_phase_timers(m_monitor_id);
+      if constexpr (std::is_base_of_v<StreamDevice, T>)
+        if (!m_trace_file.empty())
+          instance->enable_tracing(m_trace_file);
+      return instance;
+    }
+
+  private:
+    std::string m_monitor_id;
+    std::string m_trace_file;
+    const char* m_trace_scope;
+  };
+
+  // caches the state built by get_state(). streams opt in by calling invalidate()
+  // whenever their state changes, otherwise generation 0 rebuilds it on every query.
+  class StateCache {
+  public:
+    void invalidate() noexcept { m_generation.fetch_add(1, std::memory_order_release); }
+    uint64_t generation() const noexcept { return m_generation.load(std::memory_order_acquire); }
+
+    template<typename F>
+    const ValueSet& get(F&& build_state) {
+      const auto generation = this->generation();
+      if (!generation || generation != m_cached_generation) {
+        m_cached_state = build_state();
+        m_cached_generation = generation;
+      }
+      return m_cached_state;
+    }
+
+    // returns false without building the state, when it did not change since generation
+    template<typename F>
+    bool get_if_changed(uint64_t* generation, ValueSet* state, F&& build_state) {
+      const auto current = this->generation();
+      if (current && current == *generation)
+        return false;
+      *state = get(std::forward<F>(build_state));
+      *generation = m_cached_generation;
+      return true;
+    }
+
+  private:
+    std::atomic<uint64_t> m_generation{ };
+    uint64_t m_cached_generation{ };
+    ValueSet m_cached_state;
+  };
+} // namespace
+
 class InputStream : public InputStreamP {
 public:
   static InputStream* cast(InputStreamP* self) { return static_cast<InputStream*>(self); }
@@ -115,15 +677,34 @@ public:
       [](InputStreamP* p, ValueSet settings) noexcept { return cast(p)->update_settings(std::move(settings)); },
       [](InputStreamP* p, string_view name) noexcept { return cast(p)->get_property(name); },
       [](InputStreamP* p, string_view name, string value) noexcept { return cast(p)->set_property(name, std::move(value)); },
-      [](InputStreamP* p) noexcept { return cast(p)->get_state(); },
+      [](InputStreamP* p) noexcept { return cast(p)->get_cached_state(); },
       [](InputStreamP* p) noexcept { return cast(p)->get_parameter_count(); },
       [](InputStreamP* p, size_t index) noexcept -> ParameterP* { return cast(p)->get_parameter(index); },
       [](InputStreamP* p, bool requested) noexcept { cast(p)->set_video_requested(requested); },
       [](InputStreamP* p, bool requested) noexcept { cast(p)->set_audio_requested(requested); },
-      [](InputStreamP* p) noexcept { return cast(p)->update(); },
-      [](InputStreamP* p) noexcept { return cast(p)->before_render(); },
-      [](InputStreamP* p) noexcept { return cast(p)->render(); },
-      [](InputStreamP* p) noexcept { return cast(p)->after_render(); },
+      [](InputStreamP* p) noexcept { 
+        const auto scope = cast(p)->measure_phase(detail::Phase::update);
+        return cast(p)->update(); 
+      },
+      [](InputStreamP* p) noexcept { 
+        const auto scope = cast(p)->measure_phase(detail::Phase::before_render);
+        return cast(p)->before_render(); 
+      },
+      [](InputStreamP* p) noexcept { 
+        const auto scope = cast(p)->measure_phase(detail::Phase::render);
+        return cast(p)->render(); 
+      },
+      [](InputStreamP* p) noexcept { 
+        const auto scope = cast(p)->measure_phase(detail::Phase::after_render);
+        return cast(p)->after_render(); 
+      },
+      [](InputStreamP* p, const ParameterValueUpdate* updates, size_t count) noexcept { 
+        cast(p)->set_parameter_values(updates, count); 
+      },
+      [](InputStreamP* p, uint64_t* generation, ValueSet* state) noexcept {
+        return cast(p)->m_state_cache.get_if_changed(generation, state, 
+          [&]() { return cast(p)->get_state(); });
+      },
     } { }
   virtual ~InputStream() = default;
   virtual string get_property(string_view name) noexcept { return { }; }
@@ -140,31 +721,74 @@ public:
   virtual size_t get_parameter_count() noexcept { return m_parameters.size(); }
   virtual Parameter* get_parameter(size_t index) noexcept { return m_parameters[index].get(); }
 
+  // applies the values of multiple parameters at once, in the order of updates.
+  // updates with an unexpected size are skipped, e.g. when an index is off by one
+  virtual void set_parameter_values(const ParameterValueUpdate* updates, size_t count) noexcept {
+    const auto parameter_count = get_parameter_count();
+    for (auto update = updates; update != updates + count; ++update)
+      if (update->parameter_index < parameter_count)
+        if (auto parameter = get_parameter(update->parameter_index)) {
+          const auto value_size = parameter->value_size();
+          if (!value_size || update->size == value_size)
+            parameter->set_value(update->data, update->size);
+        }
+  }
+
+  // increases when the stream calls invalidate_state(), zero when it does not track changes
+  uint64_t state_generation() const noexcept { return m_state_cache.generation(); }
+
+  // publishes the durations of the phases as monitor values "stream.<id>.<phase>_ms", 
+  // called for streams created with the setting monitor_id
+  void enable_phase_timers(string_view id) {
+    m_phase_timers = detail::create_phase_monitor(m_host_context, "stream." + string(id));
+  }
+
+  // returns the monitor publishing the phase timers, which can be extended, or null
+  Monitor* phase_timers() noexcept { return m_phase_timers.get(); }
+
   Parameter* find_parameter(string_view name) noexcept {
-    const auto count = get_parameter_count();
-    for (auto i = size_t{ }; i < count; ++i)
-      if (auto parameter = get_parameter(i))
-        if (parameter->name() == name)
-          return parameter;
-    return nullptr;
+    update_parameter_index();
+    const auto it = m_parameter_names.find(name);
+    return (it != m_parameter_names.end() ? get_parameter(it->second) : nullptr);
   }
 
   Parameter* find_parameter(string_view property, string_view value) noexcept {
-    const auto count = get_parameter_count();
-    for (auto i = size_t{ }; i < count; ++i)
-      if (auto parameter = get_parameter(i))
-        if (parameter->get_property(property) == value)
-          return parameter;
-    return nullptr;
+    update_parameter_index();
+    const auto it = m_parameter_properties.find(property);
+    const auto& values = (it != m_parameter_properties.end() ? 
+      it->second : index_parameter_property(property));
+    const auto value_it = values.find(value);
+    return (value_it != values.end() ? get_parameter(value_it->second) : nullptr);
+  }
+
+  // calls callback(index, parameter) for each added parameter, whose value changed 
+  // since the previous call. The first call reports all parameters, as do 
+  // subsequent calls for parameters which do not track changes.
+  template<typename F>
+  void for_each_changed_parameter(F&& callback) {
+    m_parameter_generations.resize(m_parameters.size());
+    for (auto i = size_t{ }; i < m_parameters.size(); ++i) {
+      const auto generation = m_parameters[i]->generation();
+      if (generation && generation == m_parameter_generations[i])
+        continue;
+      m_parameter_generations[i] = generation;
+      callback(i, *m_parameters[i]);
+    }
   }
 
 protected:
   HostContext& host() noexcept { return m_host_context; }
 
+  // signals that get_state() returns a different state, can be called from any thread
+  void invalidate_state() noexcept { m_state_cache.invalidate(); }
+
   template<typename T, typename... Args>
   T* add_parameter(Args&&... args) {
-    return static_cast<T*>(m_parameters.emplace_back(
-      std::make_unique<T>(std::forward<Args>(args)...)).get());
+    auto& parameter = m_parameters.emplace_back(
+      std::make_unique<T>(std::forward<Args>(args)...));
+    parameter->m_property_changes = &m_property_changes;
+    m_indexed_parameter_count = no_index;
+    return static_cast<T*>(parameter.get());
   }
 
   template<typename T, typename... Args>
@@ -175,8 +799,62 @@ protected:
   }
 
 private:
+  friend class detail::InstanceSettings;
   HostContext m_host_context;
+  detail::StateCache m_state_cache;
+  std::unique_ptr<Monitor> m_phase_timers;
+  const char* m_trace_scope{ "stream" };
+  using ParameterIndex = std::unordered_map<string_view, size_t>;
+  static constexpr auto no_index = ~size_t{ };
+
   std::vector<std::unique_ptr<Parameter>> m_parameters;
+  std::vector<uint64_t> m_parameter_generations;
+  std::atomic<uint64_t> m_property_changes{ };
+
+  // lookup of parameters by name and by property value, 
+  // property values are indexed on demand and are stored in m_indexed_strings
+  size_t m_indexed_parameter_count{ no_index };
+  uint64_t m_indexed_property_changes{ };
+  ParameterIndex m_parameter_names;
+  std::unordered_map<string_view, ParameterIndex> m_parameter_properties;
+  std::deque<std::string> m_indexed_strings;
+
+  void update_parameter_index() {
+    const auto count = get_parameter_count();
+    const auto property_changes = m_property_changes.load(std::memory_order_relaxed);
+    if (count != m_indexed_parameter_count) {
+      m_parameter_names.clear();
+      for (auto i = size_t{ }; i < count; ++i)
+        if (auto parameter = get_parameter(i))
+          m_parameter_names.emplace(parameter->name(), i);
+      m_indexed_parameter_count = count;
+    }
+    else if (property_changes == m_indexed_property_changes) {
+      return;
+    }
+    m_parameter_properties.clear();
+    m_indexed_strings.clear();
+    m_indexed_property_changes = property_changes;
+  }
+
+  const ParameterIndex& index_parameter_property(string_view property) {
+    auto values = ParameterIndex();
+    for (auto i = size_t{ }; i < m_indexed_parameter_count; ++i)
+      if (auto parameter = get_parameter(i)) {
+        const auto& value = m_indexed_strings.emplace_back(parameter->get_property(property));
+        values.emplace(value, i);
+      }
+    const auto& name = m_indexed_strings.emplace_back(property);
+    return m_parameter_properties.emplace(name, std::move(values)).first->second;
+  }
+
+  ValueSet get_cached_state() noexcept {
+    return m_state_cache.get([&]() { return get_state(); });
+  }
+
+  detail::PhaseScope measure_phase(detail::Phase phase) noexcept {
+    return detail::PhaseScope(m_phase_timers.get(), m_trace_scope, phase);
+  }
 
   void set_audio_requested(bool requested) noexcept {
     set_audio_callback(!requested ? SendAudioFrame() :
@@ -203,15 +881,31 @@ public:
       [](OutputStreamP* p, ValueSet settings) noexcept { return cast(p)->update_settings(std::move(settings)); },
       [](OutputStreamP* p, string_view name) noexcept { return cast(p)->get_property(name); },
       [](OutputStreamP* p, string_view name, string value) noexcept { return cast(p)->set_property(name, std::move(value)); },
-      [](OutputStreamP* p) noexcept { return cast(p)->get_state(); },
+      [](OutputStreamP* p) noexcept { return cast(p)->get_cached_state(); },
       [](OutputStreamP* p, const AudioFrame* audio_frame, OnComplete on_complete) noexcept { 
         cast(p)->send_audio_frame(*audio_frame, std::move(on_complete));
       },
       [](OutputStreamP* p) noexcept { return cast(p)->get_target().release(); },
-      [](OutputStreamP* p) noexcept { return cast(p)->before_render(); },
-      [](OutputStreamP* p) noexcept { return cast(p)->after_render(); },
-      [](OutputStreamP* p) noexcept { cast(p)->present(); },
-      [](OutputStreamP* p) noexcept { cast(p)->swap(); },
+      [](OutputStreamP* p) noexcept { 
+        const auto scope = cast(p)->measure_phase(detail::Phase::before_render);
+        return cast(p)->before_render(); 
+      },
+      [](OutputStreamP* p) noexcept { 
+        const auto scope = cast(p)->measure_phase(detail::Phase::after_render);
+        return cast(p)->after_render(); 
+      },
+      [](OutputStreamP* p) noexcept { 
+        const auto scope = cast(p)->measure_phase(detail::Phase::present);
+        cast(p)->present(); 
+      },
+      [](OutputStreamP* p) noexcept { 
+        const auto scope = cast(p)->measure_phase(detail::Phase::swap);
+        cast(p)->swap(); 
+      },
+      [](OutputStreamP* p, uint64_t* generation, ValueSet* state) noexcept {
+        return cast(p)->m_state_cache.get_if_changed(generation, state, 
+          [&]() { return cast(p)->get_state(); });
+      },
     } { }
   virtual ~OutputStream() = default;
   virtual string get_property(string_view name) noexcept { return { }; }
@@ -226,11 +920,132 @@ public:
   virtual void present() noexcept { }
   virtual void swap() noexcept { }
 
+  // increases when the stream calls invalidate_state(), zero when it does not track changes
+  uint64_t state_generation() const noexcept { return m_state_cache.generation(); }
+
+  // publishes the durations of the phases as monitor values "stream.<id>.<phase>_ms", 
+  // called for streams created with the setting monitor_id
+  void enable_phase_timers(string_view id) {
+    m_phase_timers = detail::create_phase_monitor(m_host_context, "stream." + string(id));
+  }
+
+  // returns the monitor publishing the phase timers, which can be extended, or null
+  Monitor* phase_timers() noexcept { return m_phase_timers.get(); }
+
 protected:
   HostContext& host() noexcept { return m_host_context; }
 
+  // signals that get_state() returns a different state, can be called from any thread
+  void invalidate_state() noexcept { m_state_cache.invalidate(); }
+
 private:
+  friend class detail::InstanceSettings;
   HostContext m_host_context;
+  detail::StateCache m_state_cache;
+  std::unique_ptr<Monitor> m_phase_timers;
+  const char* m_trace_scope{ "stream" };
+
+  ValueSet get_cached_state() noexcept {
+    return m_state_cache.get([&]() { return get_state(); });
+  }
+
+  detail::PhaseScope measure_phase(detail::Phase phase) noexcept {
+    return detail::PhaseScope(m_phase_timers.get(), m_trace_scope, phase);
+  }
+};
+
+// keeps the enumerated stream settings and the generations in which streams were
+// added, changed and removed, to report the changes since a token. streams are 
+// identified by their handle. it is not thread safe.
+class StreamSettingsTracker {
+public:
+  explicit StreamSettingsTracker(size_t max_removed_handles = 1024)
+    : m_max_removed_handles(max_removed_handles) { }
+
+  const vector<ValueSet>& settings() const { return m_settings; }
+  uint64_t token() const { return m_generation; }
+
+  // returns whether any stream was added, changed or removed
+  bool update(vector<ValueSet> settings) {
+    const auto generation = m_generation + 1;
+    const auto update_index = ++m_update_index;
+    auto changed = false;
+    for (const auto& stream : settings) {
+      auto handle = stream.get(SettingNames::handle);
+      auto it = m_entries.find(handle);
+      if (it == m_entries.end()) {
+        m_entries.emplace(std::move(handle), Entry{ stream, generation, generation, update_index });
+        changed = true;
+      }
+      else if (it->second.settings != stream) {
+        it->second.settings = stream;
+        it->second.modified = generation;
+        it->second.update_index = update_index;
+        changed = true;
+      }
+      else {
+        it->second.update_index = update_index;
+      }
+    }
+    for (auto it = m_entries.begin(); it != m_entries.end(); ) {
+      if (it->second.update_index == update_index) {
+        ++it;
+        continue;
+      }
+      m_removed.push_back({ generation, it->first });
+      it = m_entries.erase(it);
+      changed = true;
+    }
+    while (m_removed.size() > m_max_removed_handles) {
+      m_oldest_token = m_removed.front().generation;
+      m_removed.pop_front();
+    }
+
+    m_settings = std::move(settings);
+    if (changed)
+      m_generation = generation;
+    return changed;
+  }
+
+  // returns all streams, when the token is 0, unknown or too old
+  StreamSettingsDelta get_delta(uint64_t token) const {
+    auto delta = StreamSettingsDelta{ };
+    delta.token = m_generation;
+    if (token == m_generation)
+      return delta;
+
+    if (!token || token > m_generation || token < m_oldest_token) {
+      delta.full = true;
+      delta.added = m_settings;
+      return delta;
+    }
+    for (const auto& [handle, entry] : m_entries)
+      if (entry.modified > token)
+        (entry.added > token ? delta.added : delta.changed).push_back(entry.settings);
+    for (auto it = m_removed.rbegin(); it != m_removed.rend() && it->generation > token; ++it)
+      delta.removed.emplace_back(it->handle);
+    return delta;
+  }
+
+private:
+  struct Entry {
+    ValueSet settings;
+    uint64_t added;
+    uint64_t modified;
+    uint64_t update_index;
+  };
+  struct RemovedHandle {
+    uint64_t generation;
+    std::string handle;
+  };
+
+  size_t m_max_removed_handles;
+  vector<ValueSet> m_settings;
+  std::map<std::string, Entry, std::less<>> m_entries;
+  std::deque<RemovedHandle> m_removed;
+  uint64_t m_generation{ };
+  uint64_t m_oldest_token{ };
+  uint64_t m_update_index{ };
 };
 
 class StreamDevice : public StreamDeviceP {
@@ -248,8 +1063,14 @@ public:
       [](StreamDeviceP* p, string_view name) noexcept { return cast(p)->get_property(name); },
       [](StreamDeviceP* p, string_view name, string value) noexcept { return cast(p)->set_property(name, std::move(value)); },
       [](StreamDeviceP* p) noexcept { return cast(p)->enumerate_stream_settings(); },
-      [](StreamDeviceP* p, ValueSet settings) noexcept -> InputStreamP* { return cast(p)->create_input_stream(std::move(settings)); },
-      [](StreamDeviceP* p, ValueSet settings) noexcept -> OutputStreamP* { return cast(p)->create_output_stream(std::move(settings)); },
+      [](StreamDeviceP* p, ValueSet settings) noexcept -> InputStreamP* { 
+        auto instance = detail::InstanceSettings("stream", settings);
+        return instance.apply(cast(p)->create_input_stream(std::move(settings)));
+      },
+      [](StreamDeviceP* p, ValueSet settings) noexcept -> OutputStreamP* { 
+        auto instance = detail::InstanceSettings("stream", settings);
+        return instance.apply(cast(p)->create_output_stream(std::move(settings)));
+      },
       [](StreamDeviceP* p, 
           InputStreamP* const* input_streams, size_t input_stream_count, 
           OutputStreamP* const* output_streams, size_t output_stream_count) noexcept { 
@@ -261,12 +1082,28 @@ public:
           os.push_back(OutputStream::cast(output_streams[i]));
         return cast(p)->set_active_streams(std::move(is), std::move(os));
       },
-      [](StreamDeviceP* p) noexcept { return cast(p)->update(); },
-      [](StreamDeviceP* p) noexcept { return cast(p)->before_render(); },
-      [](StreamDeviceP* p) noexcept { return cast(p)->render(); },
-      [](StreamDeviceP* p) noexcept { return cast(p)->after_render(); },
+      [](StreamDeviceP* p) noexcept { 
+        const auto scope = cast(p)->measure_phase(detail::Phase::update);
+        return cast(p)->update(); 
+      },
+      [](StreamDeviceP* p) noexcept { 
+        const auto scope = cast(p)->measure_phase(detail::Phase::before_render);
+        return cast(p)->before_render(); 
+      },
+      [](StreamDeviceP* p) noexcept { 
+        const auto scope = cast(p)->measure_phase(detail::Phase::render);
+        return cast(p)->render(); 
+      },
+      [](StreamDeviceP* p) noexcept { 
+        const auto scope = cast(p)->measure_phase(detail::Phase::after_render);
+        return cast(p)->after_render(); 
+      },
+      [](StreamDeviceP* p, uint64_t token) noexcept { return cast(p)->enumerate_stream_settings_delta(token); },
     } { }
-  virtual ~StreamDevice() = default;
+  virtual ~StreamDevice() {
+    if (!m_trace_file.empty())
+      write_trace();
+  }
   virtual string get_property(string_view name) noexcept { 
     // device name must always be readable, otherwise it is considered lost and recreated
     if (name == PropertyNames::name)
@@ -277,6 +1114,14 @@ public:
   virtual bool initialize() noexcept { return true; }
   virtual bool update_settings(ValueSet settings) noexcept { return false; }
   virtual vector<ValueSet> enumerate_stream_settings() noexcept { return { }; }
+
+  // the default implementation computes the changes of enumerate_stream_settings(),
+  // devices tracking their streams can return the changes of their own tracker
+  virtual StreamSettingsDelta enumerate_stream_settings_delta(uint64_t token) noexcept {
+    m_stream_settings.update(enumerate_stream_settings());
+    return m_stream_settings.get_delta(token);
+  }
+
   virtual InputStream* create_input_stream(ValueSet settings) noexcept { return nullptr; }
   virtual OutputStream* create_output_stream(ValueSet settings) noexcept { return nullptr; }
   virtual bool set_active_streams(const vector<InputStream*>& input_streams, 
@@ -286,6 +1131,24 @@ public:
   virtual void render() noexcept { }
   virtual SyncDesc after_render() noexcept { return { }; }
 
+  // publishes the durations of the phases as monitor values "device.<id>.<phase>_ms", 
+  // called for devices created with the setting monitor_id
+  void enable_phase_timers(string_view id) {
+    m_phase_timers = detail::create_phase_monitor(m_host_context, "device." + string(id));
+  }
+
+  // returns the monitor publishing the phase timers, which can be extended, or null
+  Monitor* phase_timers() noexcept { return m_phase_timers.get(); }
+
+  // records trace events of all devices and streams of the extension until the device
+  // is destroyed, then writes them to get_userdata_path(filename) as Chrome trace JSON.
+  // called for devices created with the setting trace_file
+  void enable_tracing(string_view filename) {
+    if (m_trace_file.empty())
+      Tracer::instance().start();
+    m_trace_file = filename;
+  }
+
 protected:
   HostContext& host() noexcept { return m_host_context; }
 
@@ -296,8 +1159,32 @@ protected:
   }
 
 private:
+  friend class detail::InstanceSettings;
   HostContext m_host_context;
   std::vector<std::unique_ptr<Parameter>> m_parameters;
+  StreamSettingsTracker m_stream_settings;
+  std::unique_ptr<Monitor> m_phase_timers;
+  const char* m_trace_scope{ "device" };
+  string m_trace_file;
+
+  void write_trace() noexcept try {
+    auto& tracer = Tracer::instance();
+    tracer.stop();
+    if (!m_host_context)
+      return;
+    const auto filename = std::string(host().get_userdata_path(m_trace_file));
+    if (filename.empty() || !tracer.write_chrome_json(filename))
+      host().log_error("writing trace '" + filename + "' failed");
+    else
+      host().log_info("trace written to '" + filename + "'");
+  }
+  catch (const std::exception& ex) {
+    host().log_error(std::string("writing trace failed: ") + ex.what());
+  }
+
+  detail::PhaseScope measure_phase(detail::Phase phase) noexcept {
+    return detail::PhaseScope(m_phase_timers.get(), m_trace_scope, phase);
+  }
 };
 
 class Extension : public ExtensionP {
@@ -312,15 +1199,25 @@ public:
       },
       [](ExtensionP* p) noexcept { cast(p)->shutdown(); },
       [](ExtensionP* p, string_view name) noexcept { 
-        if (name == PropertyNames::api_version)
-          return string(api_version);
-        if (name == PropertyNames::build_date)
-          return string(__DATE__);
+        const auto atom = Atom(name);
+        switch (atom) {
+          case Atom(PropertyNames::api_version):
+            if (atom.is(PropertyNames::api_version))
+              return string(api_version);
+            break;
+          case Atom(PropertyNames::build_date):
+            if (atom.is(PropertyNames::build_date))
+              return string(__DATE__);
+            break;
+        }
         return cast(p)->get_property(name); 
       },
       [](ExtensionP* p, string_view name, string value) noexcept { return cast(p)->set_property(name, std::move(value)); },
       [](ExtensionP* p) noexcept { return cast(p)->enumerate_stream_device_settings(); },
-      [](ExtensionP* p, ValueSet settings) noexcept -> StreamDeviceP* { return cast(p)->create_stream_device(std::move(settings)); },
+      [](ExtensionP* p, ValueSet settings) noexcept -> StreamDeviceP* { 
+        auto instance = detail::InstanceSettings("device", settings);
+        return instance.apply(cast(p)->create_stream_device(std::move(settings)));
+      },
     } { }
   virtual ~Extension() = default;
   virtual bool initialize() noexcept { return true; }
@@ -339,6 +1236,25 @@ private:
 
 //-------------------------------------------------------------------------
 
+// returns a process wide unique copy of a string, which stays valid until exit.
+// Allows to share the property names of all parameters and the trace scopes,
+// must only be used for strings of a bounded set.
+inline const std::string* intern_string(string_view string) {
+  static auto s_mutex = std::mutex();
+  static auto s_strings = std::unordered_map<string_view, std::unique_ptr<const std::string>>();
+
+  const auto lock = std::lock_guard(s_mutex);
+  const auto it = s_strings.find(string);
+  if (it != s_strings.end())
+    return it->second.get();
+  auto copy = std::make_unique<const std::string>(string);
+  const auto interned = copy.get();
+  s_strings.emplace(*interned, std::move(copy));
+  return interned;
+}
+
+//-------------------------------------------------------------------------
+
 class ParameterBase : public rxext::Parameter {
 public:
   using Parameter::set_property;
@@ -348,15 +1264,34 @@ public:
 
   string get_property(string_view name) const noexcept override {
     const auto lock = std::lock_guard(mutex());
-    const auto it = m_properties.find(name);
-    return string(it != m_properties.end() ? it->second : string());
+    for (const auto& property : m_properties)
+      if (*property.name == name)
+        return string(property.value);
+    return { };
   }
 
-  bool set_property(string_view name, string value) noexcept override {
+  bool set_property(string_view name, string value) noexcept override try {
     const auto lock = std::lock_guard(mutex());
-    m_properties[string(name)] = std::move(value);
+    for (auto& property : m_properties)
+      if (*property.name == name) {
+        property.value.assign(value.data(), value.size());
+        property_changed();
+        return true;
+      }
+    // only the names are interned, values are set by the host at runtime
+    if (m_properties.empty())
+      m_properties.reserve(4);
+    m_properties.push_back({ intern_string(name), std::string(value) });
+    property_changed();
     return true;
   }
+  catch (...) {
+    return false;
+  }
+
+  uint64_t generation() const noexcept override {
+    return m_generation.load(std::memory_order_acquire);
+  }
 
   template<typename T>
   T get_property(string_view name) const noexcept {
@@ -372,14 +1307,133 @@ protected:
     return m_mutex;
   }
 
+  // to be called after the value was changed
+  void value_changed() noexcept {
+    m_generation.fetch_add(1, std::memory_order_release);
+  }
+
 private:
+  struct Property {
+    const std::string* name;
+    std::string value;
+  };
+
   const ParameterType m_type;
   const std::string m_name;
   mutable std::mutex m_mutex;
-  std::map<string, string, std::less<>> m_properties;
+  std::atomic<uint64_t> m_generation{ 1 };
+  std::vector<Property> m_properties;
+};
+
+// value storage guarded by a mutex, works for any copyable type
+template<typename T>
+class MutexStorage {
+public:
+  explicit MutexStorage(const T& value) : m_value(value) { }
+
+  void store(const T& value) {
+    const auto lock = std::lock_guard(m_mutex);
+    m_value = value;
+  }
+
+  T load() const {
+    const auto lock = std::lock_guard(m_mutex);
+    return m_value;
+  }
+
+private:
+  mutable std::mutex m_mutex;
+  T m_value;
+};
+
+// lock-free value storage for trivially copyable types, readers never block and
+// do not write to shared memory. Writers fill the slot which is not published
+// and then publish it, so a preempted writer does not stall readers. Each slot
+// is guarded by a sequence lock, readers retry in the rare case their slot is
+// overwritten while reading.
+template<typename T>
+class SeqLockStorage {
+public:
+  static_assert(std::is_trivially_copyable_v<T>);
+
+  explicit SeqLockStorage(const T& value) {
+    write_words(m_slots[0], value);
+  }
+
+  void store(const T& value) {
+    // make version sequence odd while writing, serializes concurrent writers
+    auto sequence = m_sequence.load(std::memory_order_relaxed);
+    for (;;) {
+      if (sequence & 1) {
+        std::this_thread::yield();
+        sequence = m_sequence.load(std::memory_order_relaxed);
+      }
+      else if (m_sequence.compare_exchange_weak(sequence, sequence + 1,
+          std::memory_order_acquire, std::memory_order_relaxed)) {
+        break;
+      }
+    }
+
+    auto& slot = m_slots[(sequence / 2 + 1) % 2];
+    const auto slot_sequence = slot.sequence.load(std::memory_order_relaxed);
+    slot.sequence.store(slot_sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    write_words(slot, value);
+    slot.sequence.store(slot_sequence + 2, std::memory_order_release);
+
+    // publish slot
+    m_sequence.store(sequence + 2, std::memory_order_release);
+  }
+
+  T load() const {
+    auto words = Words{ };
+    for (;;) {
+      const auto& slot = m_slots[version() % 2];
+      const auto slot_sequence = slot.sequence.load(std::memory_order_acquire);
+      if (slot_sequence & 1)
+        continue;
+      for (auto i = size_t{ }; i < word_count; ++i)
+        words[i] = slot.words[i].load(std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (slot.sequence.load(std::memory_order_relaxed) == slot_sequence)
+        break;
+    }
+    auto value = T{ };
+    std::memcpy(&value, words.data(), sizeof(T));
+    return value;
+  }
+
+  // number of completed stores
+  uint64_t version() const {
+    return m_sequence.load(std::memory_order_acquire) / 2;
+  }
+
+private:
+  static constexpr auto word_count = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+  using Words = std::array<uint64_t, word_count>;
+
+  struct alignas(64) Slot {
+    std::atomic<uint64_t> sequence{ };
+    std::array<std::atomic<uint64_t>, word_count> words{ };
+  };
+
+  static void write_words(Slot& slot, const T& value) {
+    auto words = Words{ };
+    std::memcpy(words.data(), &value, sizeof(T));
+    for (auto i = size_t{ }; i < word_count; ++i)
+      slot.words[i].store(words[i], std::memory_order_relaxed);
+  }
+
+  alignas(64) std::atomic<uint64_t> m_sequence{ };
+  Slot m_slots[2];
 };
 
-template<typename T, ParameterType Type>
+template<typename T>
+using ParameterStorage = std::conditional_t<
+  std::is_trivially_copyable_v<T> && std::is_default_constructible_v<T>,
+  SeqLockStorage<T>, MutexStorage<T>>;
+
+template<typename T, ParameterType Type, typename Storage = ParameterStorage<T>>
 class ParameterT : public ParameterBase {
 public:
   ParameterT(std::string name, const T& default_value = T{ }) 
@@ -387,28 +1441,31 @@ public:
       m_value(default_value) {
   }
   void set_value(const void* data, size_t size) noexcept override {
-    const auto lock = std::lock_guard(mutex());
-    m_value = *static_cast<const T*>(data);
+    if (size < sizeof(T))
+      return;
+    m_value.store(*static_cast<const T*>(data));
+    value_changed();
   }
+  size_t value_size() const noexcept override { return sizeof(T); }
   void get_value(void* data, size_t* size) const noexcept override {
-    const auto lock = std::lock_guard(mutex());
     if (size) {
-      if (*size >= sizeof(T))
-        std::memcpy(data, &m_value, sizeof(T));
+      if (*size >= sizeof(T)) {
+        const auto value = m_value.load();
+        std::memcpy(data, &value, sizeof(T));
+      }
       *size = sizeof(T);
     }
   }
   void set_value(const T& value) {
-    const auto lock = std::lock_guard(mutex());
-    m_value = value; 
+    m_value.store(value);
+    value_changed();
   }
   T value() const {
-    const auto lock = std::lock_guard(mutex());
-    return m_value; 
+    return m_value.load();
   }
 
 private:
-  T m_value{ };
+  Storage m_value;
 };
 
 using ParameterBool = ParameterT<bool, ParameterType::Bool>;
@@ -431,6 +1488,7 @@ public:
     const auto begin = static_cast<const char*>(data);
     const auto end = begin + size;
     m_value = std::string(begin, end);
+    value_changed();
   }
   void get_value(void* data, size_t* size) const noexcept override {
     const auto lock = std::lock_guard(mutex());
@@ -443,6 +1501,7 @@ public:
   void set_value(std::string string) {
     const auto lock = std::lock_guard(mutex());
     m_value = std::move(string);
+    value_changed();
   }
   std::string value() const {
     const auto lock = std::lock_guard(mutex());
@@ -462,6 +1521,7 @@ public:
     const auto lock = std::lock_guard(mutex());
     m_value.resize(size);
     std::memcpy(m_value.data(), data, size);
+    value_changed();
   }
   void get_value(void* data, size_t* size) const noexcept override {
     const auto lock = std::lock_guard(mutex());
@@ -504,6 +1564,7 @@ public:
   void set_texture(TextureRef texture) {
     const auto lock = std::lock_guard(mutex());
     m_texture = std::move(texture);
+    value_changed();
   }
   const TextureRef& texture() const {
     // no lock needed since it is not settable by host
@@ -540,6 +1601,7 @@ public:
   void set_textures(vector<TextureRef> textures) {
     const auto lock = std::lock_guard(mutex());
     m_textures = std::move(textures);
+    value_changed();
   }
   const vector<TextureRef>& textures() const { 
     // no lock needed since it is not settable by host
@@ -567,83 +1629,673 @@ void update_input_texture(const ParameterTexture& parameter,
 
 //-------------------------------------------------------------------------
 
+// timeline, which only increases, threads can wait on it to reach a value.
+// waiting blocks on a futex on Linux and on a condition variable elsewhere.
+class CpuTimeline : public CpuTimelineP {
+public:
+  CpuTimeline()
+    : CpuTimelineP{
+      [](CpuTimelineP* p) noexcept { return cast(p)->value(); },
+      [](CpuTimelineP* p, uint64_t value) noexcept { cast(p)->signal(value); },
+      [](CpuTimelineP* p, uint64_t value, uint64_t timeout_ns) noexcept {
+        return cast(p)->wait(value, std::chrono::nanoseconds(
+          std::min(timeout_ns, static_cast<uint64_t>(std::chrono::nanoseconds::max().count()))));
+      },
+    } { }
+  CpuTimeline(const CpuTimeline&) = delete;
+  CpuTimeline& operator=(const CpuTimeline&) = delete;
+
+  uint64_t value() const noexcept { return m_value.load(std::memory_order_acquire); }
+
+  // values lower than the current value are ignored
+  void signal(uint64_t value) noexcept {
+    auto current = m_value.load(std::memory_order_relaxed);
+    do {
+      if (current >= value)
+        return;
+    } while (!m_value.compare_exchange_weak(current, value, 
+      std::memory_order_release, std::memory_order_relaxed));
+
+    m_sequence.fetch_add(1, std::memory_order_seq_cst);
+    if (m_waiters.load(std::memory_order_seq_cst))
+      wake_all();
+  }
+
+  // returns false when the value was not reached within the timeout
+  bool wait(uint64_t value, std::chrono::nanoseconds timeout) noexcept {
+    if (this->value() >= value)
+      return true;
+
+    using Clock = std::chrono::steady_clock;
+    const auto start = Clock::now();
+    auto reached = false;
+    m_waiters.fetch_add(1, std::memory_order_seq_cst);
+    for (;;) {
+      const auto sequence = m_sequence.load(std::memory_order_seq_cst);
+      if (this->value() >= value) {
+        reached = true;
+        break;
+      }
+      const auto elapsed = Clock::now() - start;
+      if (elapsed >= timeout)
+        break;
+      wait_for_change(sequence, timeout - elapsed);
+    }
+    m_waiters.fetch_sub(1, std::memory_order_relaxed);
+    return reached;
+  }
+
+  SyncDesc sync_desc(uint64_t value) noexcept {
+    return { SyncStrategy::CpuTimeline, 
+      ShareHandle{ HandleType::RX_CPU_TIMELINE, static_cast<CpuTimelineP*>(this) }, value };
+  }
+
+private:
+  static CpuTimeline* cast(CpuTimelineP* self) { return static_cast<CpuTimeline*>(self); }
+
+#if defined(__linux__)
+  void wait_for_change(uint32_t sequence, std::chrono::nanoseconds timeout) noexcept {
+    const auto seconds = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+    auto time = timespec{ };
+    time.tv_sec = static_cast<time_t>(std::min(seconds.count(), 
+      static_cast<std::chrono::seconds::rep>(std::numeric_limits<time_t>::max())));
+    time.tv_nsec = static_cast<long>((timeout - seconds).count());
+    syscall(SYS_futex, &m_sequence, FUTEX_WAIT_PRIVATE, sequence, &time, nullptr, 0);
+  }
+
+  void wake_all() noexcept {
+    syscall(SYS_futex, &m_sequence, FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+  }
+#else
+  void wait_for_change(uint32_t sequence, std::chrono::nanoseconds timeout) noexcept {
+    auto lock = std::unique_lock(m_mutex);
+    m_signal.wait_for(lock, timeout, [&]() { 
+      return (m_sequence.load(std::memory_order_relaxed) != sequence); 
+    });
+  }
+
+  void wake_all() noexcept {
+    { auto lock = std::lock_guard(m_mutex); }
+    m_signal.notify_all();
+  }
+
+  std::mutex m_mutex;
+  std::condition_variable m_signal;
+#endif
+
+  std::atomic<uint64_t> m_value{ };
+  std::atomic<uint32_t> m_sequence{ };
+  std::atomic<uint32_t> m_waiters{ };
+};
+
+//-------------------------------------------------------------------------
+
+// bounded lock-free queue with a sequence number per cell,
+// any number of threads may push and pop concurrently.
+// a cell's sequence is 2 * position while it is free for the push at position
+// and 2 * position + 1 while it holds the value pushed at position.
+template<typename T>
+class BoundedQueue {
+public:
+  explicit BoundedQueue(size_t capacity)
+    : m_capacity(std::max(capacity, size_t{ 1 })),
+      m_cells(new Cell[m_capacity]) {
+    for (auto i = size_t{ }; i < m_capacity; ++i)
+      m_cells[i].sequence.store(2 * i, std::memory_order_relaxed);
+  }
+  BoundedQueue(const BoundedQueue&) = delete;
+  BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+  size_t capacity() const { return m_capacity; }
+
+  // approximate when called concurrently
+  size_t size() const {
+    const auto head = m_head.load(std::memory_order_acquire);
+    const auto tail = m_tail.load(std::memory_order_acquire);
+    return (tail > head ? std::min(tail - head, m_capacity) : 0);
+  }
+
+  // value is only moved from when pushed
+  bool try_push(T&& value) {
+    auto position = m_tail.load(std::memory_order_relaxed);
+    for (;;) {
+      auto& cell = m_cells[position % m_capacity];
+      const auto sequence = cell.sequence.load(std::memory_order_acquire);
+      const auto difference = static_cast<std::ptrdiff_t>(sequence - 2 * position);
+      if (difference == 0) {
+        if (m_tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+          cell.value = std::move(value);
+          cell.sequence.store(2 * position + 1, std::memory_order_release);
+          return true;
+        }
+      }
+      else if (difference < 0) {
+        return false;
+      }
+      else {
+        position = m_tail.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  bool try_pop(T& value) {
+    auto position = m_head.load(std::memory_order_relaxed);
+    for (;;) {
+      auto& cell = m_cells[position % m_capacity];
+      const auto sequence = cell.sequence.load(std::memory_order_acquire);
+      const auto difference = static_cast<std::ptrdiff_t>(sequence - (2 * position + 1));
+      if (difference == 0) {
+        if (m_head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+          value = std::move(cell.value);
+          cell.value = T{ };
+          cell.sequence.store(2 * (position + m_capacity), std::memory_order_release);
+          return true;
+        }
+      }
+      else if (difference < 0) {
+        return false;
+      }
+      else {
+        position = m_head.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+private:
+  struct Cell {
+    std::atomic<size_t> sequence;
+    T value;
+  };
+
+  const size_t m_capacity;
+  const std::unique_ptr<Cell[]> m_cells;
+  alignas(64) std::atomic<size_t> m_head{ };
+  alignas(64) std::atomic<size_t> m_tail{ };
+};
+
+//-------------------------------------------------------------------------
+
+enum class FrameDropPolicy {
+  DropNewest,   // keep queued frames, discard arriving frames when full
+  DropOldest,   // discard the oldest queued frame when full
+  LatestOnly,   // always present the newest frame, discard all older ones
+};
+
+struct FrameQueueSettings {
+  size_t depth{ 4 };
+  FrameDropPolicy drop_policy{ FrameDropPolicy::DropNewest };
+  // negative disables the jitter buffer
+  double target_latency_ms{ -1 };
+  // set by hosts, which wait and signal SyncStrategy::CpuTimeline
+  bool cpu_timeline{ false };
+};
+
+struct FrameQueueStats {
+  uint64_t frames_received;
+  uint64_t frames_dropped;
+  size_t occupancy;
+  size_t depth;
+  double latency_ms;
+};
+
+inline FrameDropPolicy get_frame_drop_policy_by_name(string_view name,
+    FrameDropPolicy default_policy) {
+  if (name == "drop_newest") return FrameDropPolicy::DropNewest;
+  if (name == "drop_oldest") return FrameDropPolicy::DropOldest;
+  if (name == "latest_only") return FrameDropPolicy::LatestOnly;
+  return default_policy;
+}
+
+// allows the host to override the defaults of an extension per stream
+inline FrameQueueSettings get_frame_queue_settings(const ValueSet& settings,
+    FrameQueueSettings defaults = { }) {
+  auto result = defaults;
+  result.depth = settings.get<size_t>(SettingNames::frame_queue_depth, defaults.depth);
+  result.drop_policy = get_frame_drop_policy_by_name(
+    settings.get(SettingNames::frame_drop_policy, ""), defaults.drop_policy);
+  result.target_latency_ms = settings.get<double>(
+    SettingNames::target_latency_ms, defaults.target_latency_ms);
+  result.cpu_timeline = settings.get<bool>(SettingNames::cpu_timeline, defaults.cpu_timeline);
+  return result;
+}
+
 class MemoryInputStream : public InputStream {
+public:
+  FrameQueueStats frame_queue_stats() const {
+    return {
+      m_frames_received.load(std::memory_order_relaxed),
+      m_frames_dropped.load(std::memory_order_relaxed),
+      m_frame_queue.size() + m_pending_count.load(std::memory_order_relaxed),
+      m_frame_queue.capacity(),
+      static_cast<double>(m_latency_ns.load(std::memory_order_relaxed)) / 1e6,
+    };
+  }
+
 protected:
-  MemoryInputStream() 
-    : m_sampler(*add_output_parameter<ParameterTextureSet>("sampler")) {
+  explicit MemoryInputStream(FrameQueueSettings frame_queue = { })
+    : m_sampler(*add_output_parameter<ParameterTextureSet>("sampler")),
+      m_drop_policy(frame_queue.drop_policy),
+      m_target_latency_ns(static_cast<int64_t>(frame_queue.target_latency_ms * 1e6)),
+      m_frame_queue(frame_queue.depth) {
+    if (m_target_latency_ns >= 0)
+      m_pending.reserve(m_frame_queue.capacity());
+    if (frame_queue.cpu_timeline)
+      m_sampled_timeline = std::make_unique<CpuTimeline>();
   }
 
   void set_video_requested(bool requested) noexcept override {
     set_video_callback(!requested ? SendVideoFrame() :
       [this](const VideoFrame& video_frame, OnComplete on_complete) noexcept {
+        const auto& timestamps = video_frame.timestamps;
+        const auto arrival = (timestamps.capture_time_ns ? 
+          timestamps.capture_time_ns : get_timestamp_ns());
+        const auto presentation = (timestamps.presentation_time_ns ? 
+          timestamps.presentation_time_ns : arrival);
         host().unpack_video_frame(video_frame, 
-          [this, on_complete = std::move(on_complete)](vector<TextureRef> textures) mutable noexcept {
-            on_frame_unpacked(std::move(textures));
+          [this, on_complete = std::move(on_complete), arrival, presentation]
+              (vector<TextureRef> textures) mutable noexcept {
+            on_frame_unpacked({ std::move(textures), arrival, presentation });
             on_complete();
           });
       });
   }
 
   bool update() noexcept override {
-    const auto lock = std::lock_guard(m_mutex);
-    if (!m_frame_textures.empty()) {
-      m_sampler.set_textures(m_frame_textures.front());
-      m_frame_textures.erase(m_frame_textures.begin());
+    // keep the queued frames, while the host is still sampling depth frames
+    if (m_sampled_timeline) {
+      const auto sampled = m_sampled_timeline->value();
+      while (!m_in_flight.empty() && m_in_flight.front().value <= sampled)
+        m_in_flight.pop_front();
+      if (m_in_flight.size() >= m_frame_queue.capacity())
+        return true;
     }
+
+    if (m_target_latency_ns >= 0)
+      present_due_frame();
+    else
+      present_queued_frame();
     return true;
   }
 
+  // the host signals the number of the presented frame, when it finished sampling it
+  SyncDesc after_render() noexcept override {
+    if (!m_sampled_timeline)
+      return { };
+    return m_sampled_timeline->sync_desc(m_frames_presented);
+  }
+
   virtual void set_video_callback(SendVideoFrame&& send_video_frame) noexcept = 0;
 
 private:
-  using FrameTextures = vector<TextureRef>;
+  struct QueuedFrame {
+    vector<TextureRef> textures;
+    int64_t arrival_ns;
+    int64_t presentation_ns;
+  };
+
+  // minimum over the last one to two windows of frames, so it follows clock drift
+  class WindowedMinimum {
+  public:
+    void add(int64_t value) {
+      // restart when the stream's time base jumped back
+      if (value > minimum() + reset_threshold_ns)
+        m_current = m_previous = no_value;
+      m_current = std::min(m_current, value);
+      if (++m_count == window) {
+        m_previous = std::exchange(m_current, no_value);
+        m_count = 0;
+      }
+    }
+    int64_t minimum() const { return std::min(m_current, m_previous); }
+
+  private:
+    static constexpr auto window = size_t{ 120 };
+    static constexpr auto no_value = std::numeric_limits<int64_t>::max() / 2;
+    static constexpr auto reset_threshold_ns = int64_t{ 1'000'000'000 };
 
-  void on_frame_unpacked(vector<TextureRef> textures) noexcept {
-    if (textures.empty())
+    int64_t m_current{ no_value };
+    int64_t m_previous{ no_value };
+    size_t m_count{ };
+  };
+
+  void on_frame_unpacked(QueuedFrame frame) noexcept {
+    if (frame.textures.empty())
       return;
-    const auto lock = std::lock_guard(m_mutex);
-    if (m_frame_textures.size() < 4)
-      m_frame_textures.push_back(textures);
+    m_frames_received.fetch_add(1, std::memory_order_relaxed);
+
+    while (!m_frame_queue.try_push(std::move(frame))) {
+      if (m_drop_policy == FrameDropPolicy::DropNewest) {
+        m_frames_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+      }
+      auto oldest = QueuedFrame();
+      if (m_frame_queue.try_pop(oldest))
+        m_frames_dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  void present_queued_frame() {
+    auto frame = QueuedFrame();
+    if (!m_frame_queue.try_pop(frame))
+      return;
+
+    if (m_drop_policy == FrameDropPolicy::LatestOnly)
+      for (auto newer = QueuedFrame(); m_frame_queue.try_pop(newer); ) {
+        frame = std::move(newer);
+        m_frames_dropped.fetch_add(1, std::memory_order_relaxed);
+      }
+    present_frame(std::move(frame), get_timestamp_ns());
+  }
+
+  // presents the newest frame, which is due at its presentation time
+  // plus the minimum transit time plus the target latency
+  void present_due_frame() {
+    for (auto frame = QueuedFrame(); m_frame_queue.try_pop(frame); ) {
+      m_transit_time.add(frame.arrival_ns - frame.presentation_ns);
+      if (m_pending.size() >= m_frame_queue.capacity()) {
+        m_pending.erase(m_pending.begin());
+        m_frames_dropped.fetch_add(1, std::memory_order_relaxed);
+      }
+      m_pending.push_back(std::move(frame));
+    }
+
+    const auto now = get_timestamp_ns();
+    const auto delay = m_transit_time.minimum() + m_target_latency_ns;
+    auto due = size_t{ };
+    while (due < m_pending.size() && m_pending[due].presentation_ns + delay <= now)
+      ++due;
+    if (due) {
+      m_frames_dropped.fetch_add(due - 1, std::memory_order_relaxed);
+      present_frame(std::move(m_pending[due - 1]), now);
+      m_pending.erase(m_pending.begin(), m_pending.begin() + due);
+    }
+    m_pending_count.store(m_pending.size(), std::memory_order_relaxed);
+  }
+
+  void present_frame(QueuedFrame frame, int64_t now) {
+    m_latency_ns.store(now - frame.arrival_ns, std::memory_order_relaxed);
+    // keep the previous frame until the host signals that it was sampled
+    if (m_sampled_timeline && m_frames_presented)
+      m_in_flight.push_back({ m_frames_presented, m_sampler.textures() });
+    ++m_frames_presented;
+    m_sampler.set_textures(std::move(frame.textures));
   }
 
   ParameterTextureSet& m_sampler;
+  const FrameDropPolicy m_drop_policy;
+  const int64_t m_target_latency_ns;
+  BoundedQueue<QueuedFrame> m_frame_queue;
+  std::atomic<uint64_t> m_frames_received{ };
+  std::atomic<uint64_t> m_frames_dropped{ };
+  std::atomic<int64_t> m_latency_ns{ };
+  std::atomic<size_t> m_pending_count{ };
+  // only accessed by update
+  std::vector<QueuedFrame> m_pending;
+  WindowedMinimum m_transit_time;
+
+  struct InFlightFrame {
+    uint64_t value;
+    vector<TextureRef> textures;
+  };
+  std::unique_ptr<CpuTimeline> m_sampled_timeline;
+  std::deque<InFlightFrame> m_in_flight;
+  uint64_t m_frames_presented{ };
+};
+
+//-------------------------------------------------------------------------
+
+// captures frames on a dedicated thread, which runs while video or audio is requested.
+// derived classes block in capture until frames arrive and pass them to 
+// send_video_frame / send_audio_frame. their destructors need to call stop_capture_thread.
+class CaptureThreadInputStream : public MemoryInputStream {
+public:
+  ~CaptureThreadInputStream() override {
+    stop_capture_thread();
+  }
+
+protected:
+  explicit CaptureThreadInputStream(FrameQueueSettings frame_queue = { },
+      std::chrono::milliseconds capture_timeout = std::chrono::milliseconds(100))
+    : MemoryInputStream(frame_queue),
+      m_capture_timeout(capture_timeout) {
+  }
+
+  // should return within the timeout, so the thread can be stopped
+  virtual void capture(bool video_requested, bool audio_requested, 
+    std::chrono::milliseconds timeout) noexcept = 0;
+
+  // keeps the thread running, while neither video nor audio is requested
+  void set_capture_while_idle(bool capture_while_idle) noexcept {
+    {
+      auto lock = std::lock_guard(m_mutex);
+      m_capture_while_idle = capture_while_idle;
+    }
+    update_capture_thread();
+  }
+
+  void stop_capture_thread() noexcept {
+    auto lock = std::lock_guard(m_thread_mutex);
+    if (!m_thread.joinable())
+      return;
+    {
+      auto lock = std::lock_guard(m_mutex);
+      m_stop = true;
+    }
+    m_stop_signal.notify_all();
+    m_thread.join();
+  }
+
+  bool send_video_frame(const VideoFrame& frame, OnComplete on_complete) noexcept {
+    auto lock = std::lock_guard(m_mutex);
+    if (!m_send_video_frame)
+      return false;
+    m_send_video_frame(frame, std::move(on_complete));
+    return true;
+  }
+
+  bool send_audio_frame(const AudioFrame& frame, OnComplete on_complete) noexcept {
+    auto lock = std::lock_guard(m_mutex);
+    if (!m_send_audio_frame)
+      return false;
+    m_send_audio_frame(frame, std::move(on_complete));
+    return true;
+  }
+
+  // waits until the time or until the thread is stopped, returns whether it was not stopped
+  template<typename Clock, typename Duration>
+  bool wait_until(const std::chrono::time_point<Clock, Duration>& time) noexcept {
+    auto lock = std::unique_lock(m_mutex);
+    return !m_stop_signal.wait_until(lock, time, [&]() { return m_stop; });
+  }
+
+private:
+  void set_video_callback(SendVideoFrame&& send_video_frame) noexcept final {
+    {
+      auto lock = std::lock_guard(m_mutex);
+      m_send_video_frame = std::move(send_video_frame);
+    }
+    update_capture_thread();
+  }
+
+  void set_audio_callback(SendAudioFrame&& send_audio_frame) noexcept final {
+    {
+      auto lock = std::lock_guard(m_mutex);
+      m_send_audio_frame = std::move(send_audio_frame);
+    }
+    update_capture_thread();
+  }
+
+  void update_capture_thread() noexcept try {
+    auto lock = std::unique_lock(m_mutex);
+    const auto run = (m_send_video_frame || m_send_audio_frame || m_capture_while_idle);
+    lock.unlock();
+    if (!run) {
+      stop_capture_thread();
+      return;
+    }
+    auto thread_lock = std::lock_guard(m_thread_mutex);
+    if (m_thread.joinable())
+      return;
+    m_stop = false;
+    m_thread = std::thread([this]() noexcept { capture_thread(); });
+  }
+  catch (const std::exception& ex) {
+    host().log_error(std::string("starting capture thread failed: ") + ex.what());
+  }
+
+  void capture_thread() noexcept {
+    for (;;) {
+      auto lock = std::unique_lock(m_mutex);
+      if (m_stop)
+        break;
+      const auto video_requested = static_cast<bool>(m_send_video_frame);
+      const auto audio_requested = static_cast<bool>(m_send_audio_frame);
+      lock.unlock();
+      capture(video_requested, audio_requested, m_capture_timeout);
+    }
+  }
+
+  const std::chrono::milliseconds m_capture_timeout;
   std::mutex m_mutex;
-  std::vector<FrameTextures> m_frame_textures;
+  std::condition_variable m_stop_signal;
+  SendVideoFrame m_send_video_frame;
+  SendAudioFrame m_send_audio_frame;
+  bool m_capture_while_idle{ };
+  bool m_stop{ };
+  std::mutex m_thread_mutex;
+  std::thread m_thread;
 };
 
 //-------------------------------------------------------------------------
 
+struct TargetPoolStats {
+  size_t pool_size;
+  size_t targets_allocated;
+  size_t downloads_outstanding;
+  uint64_t exhaustion_events;
+  double oldest_download_ms;
+};
+
 class MemoryOutputStream : public OutputStream {
+public:
+  TargetPoolStats target_pool_stats() const {
+    auto lock = std::lock_guard(m_mutex);
+    auto stats = TargetPoolStats{ };
+    stats.pool_size = m_targets.size();
+    stats.targets_allocated = m_targets_allocated;
+    stats.downloads_outstanding = m_downloads_outstanding;
+    stats.exhaustion_events = m_exhaustion_events;
+    const auto now = Clock::now();
+    for (auto i = size_t{ }; i < m_targets_allocated; ++i)
+      if (m_targets[i].downloads)
+        stats.oldest_download_ms = std::max(stats.oldest_download_ms,
+          std::chrono::duration<double, std::milli>(now - m_targets[i].download_start).count());
+    return stats;
+  }
+
+  ValueSet get_state() noexcept override {
+    const auto stats = target_pool_stats();
+    auto state = ValueSet();
+    state.set(StateNames::target_pool_size, stats.pool_size);
+    state.set(StateNames::downloads_outstanding, stats.downloads_outstanding);
+    state.set(StateNames::target_pool_exhaustions, stats.exhaustion_events);
+    state.set(StateNames::oldest_download_ms, stats.oldest_download_ms);
+    return state;
+  }
+
 protected:
-  explicit MemoryOutputStream(TextureDesc target_desc) 
-    : m_target_desc(target_desc) {
+  // with cpu_timeline set, hosts can render to targets which are still being 
+  // downloaded, after waiting for the SyncDesc returned by before_render.
+  // the TargetsExhausted event is only sent when the host opted in, older hosts
+  // do not know the category.
+  explicit MemoryOutputStream(TextureDesc target_desc, size_t target_pool_size = 4,
+      bool cpu_timeline = false, bool targets_exhausted_event = false) 
+    : m_target_desc(target_desc),
+      m_targets(std::max(target_pool_size, size_t{ 1 })),
+      m_free_targets(m_targets.size()),
+      m_targets_exhausted_event(targets_exhausted_event) {
+    if (cpu_timeline)
+      m_downloaded_timeline = std::make_unique<CpuTimeline>();
   }
 
+  // returns no target while all targets are being downloaded, which is counted and
+  // signalled to the host once until a target is free again. with a CPU timeline 
+  // the target whose download started first is returned instead.
   TextureRef get_target() noexcept override {
-    auto lock = std::lock_guard(m_mutex);
+    auto lock = std::unique_lock(m_mutex);
     if (!m_video_requested)
       return { };
 
-    if (m_targets.empty()) {
-      if (m_targets_allocated >= 4)
+    if (m_current_target == no_target) {
+      if (m_free_count) {
+        m_current_target = m_free_targets[m_free_begin];
+        m_free_begin = (m_free_begin + 1) % m_free_targets.size();
+        --m_free_count;
+      }
+      else if (m_targets_allocated < m_targets.size()) {
+        m_targets[m_targets_allocated].texture = host().create_texture(m_target_desc);
+        m_current_target = m_targets_allocated++;
+      }
+      else if (m_downloaded_timeline && !m_download_order.empty()) {
+        m_current_target = m_download_order.front().target;
+      }
+      else {
+        ++m_exhaustion_events;
+        if (!std::exchange(m_exhausted, true) && m_targets_exhausted_event) {
+          const auto message = "all " + std::to_string(m_targets.size()) + 
+            " targets are being downloaded";
+          lock.unlock();
+          host().send_event(EventSeverity::Info, EventCategory::TargetsExhausted, message);
+        }
         return { };
-      m_targets.emplace_back(host().create_texture(m_target_desc));
-      ++m_targets_allocated;
+      }
+      m_exhausted = false;
     }
-    return m_targets.front();
+    return m_targets[m_current_target].texture;
   }
   
+  // the host waits until the last download of the current target completed
+  SyncDesc before_render() noexcept override {
+    if (!m_downloaded_timeline)
+      return { };
+    auto lock = std::lock_guard(m_mutex);
+    const auto value = (m_current_target != no_target ? 
+      m_targets[m_current_target].download_value : 0);
+    return m_downloaded_timeline->sync_desc(value);
+  }
+
   void present() noexcept override {
     auto lock = std::unique_lock(m_mutex);
-    auto target = std::move(m_targets.front());
-    m_targets.erase(m_targets.begin());
+    const auto index = std::exchange(m_current_target, no_target);
+    if (index == no_target)
+      return;
+    // with a CPU timeline a target can be presented again while it is downloading
+    auto& target = m_targets[index];
+    if (!target.downloads++)
+      target.download_start = Clock::now();
+    const auto value = ++m_downloads_started;
+    target.download_value = value;
+    ++m_downloads_outstanding;
+    if (m_downloaded_timeline)
+      m_download_order.push_back({ index, value, false });
+    auto texture = target.texture;
     lock.unlock();
 
-    host().download_texture(target,
-      [this, target](BufferDesc data) mutable noexcept {
-        auto lock = std::lock_guard(m_mutex);
+    host().download_texture(texture,
+      [this, index, value](BufferDesc data) mutable noexcept {
+        auto lock = std::unique_lock(m_mutex);
         send_texture_data(data);
-        m_targets.push_back(std::move(target));
+        --m_downloads_outstanding;
+        // the target is free once its last download completed
+        if (!--m_targets[index].downloads && index != m_current_target) {
+          m_free_targets[(m_free_begin + m_free_count) % m_free_targets.size()] = index;
+          ++m_free_count;
+        }
+        if (m_downloaded_timeline) {
+          // the values of the downloads in the order are consecutive
+          m_download_order[value - m_download_order.front().value].completed = true;
+          signal_completed_downloads(lock);
+        }
       });
   }
 
@@ -657,11 +2309,235 @@ protected:
   }
 
 private:
-  std::mutex m_mutex;
+  using Clock = std::chrono::steady_clock;
+  static constexpr auto no_target = ~size_t{ };
+
+  struct Target {
+    TextureRef texture;
+    // number of outstanding downloads
+    size_t downloads{ };
+    // when the target started downloading, while downloads are outstanding
+    Clock::time_point download_start;
+    // value of the last download
+    uint64_t download_value{ };
+  };
+
+  struct Download {
+    size_t target;
+    uint64_t value;
+    bool completed;
+  };
+
+  // the timeline reaches the value of a download, when it and all earlier ones completed
+  void signal_completed_downloads(std::unique_lock<std::mutex>& lock) {
+    auto value = uint64_t{ };
+    while (!m_download_order.empty() && m_download_order.front().completed) {
+      value = m_download_order.front().value;
+      m_download_order.pop_front();
+    }
+    lock.unlock();
+    if (value)
+      m_downloaded_timeline->signal(value);
+  }
+
+  mutable std::mutex m_mutex;
   const TextureDesc m_target_desc;
-  std::vector<TextureRef> m_targets;
+  std::vector<Target> m_targets;
   size_t m_targets_allocated{ };
+  size_t m_current_target{ no_target };
+  // ring of indices of targets, which were downloaded, in the order they completed
+  std::vector<size_t> m_free_targets;
+  size_t m_free_begin{ };
+  size_t m_free_count{ };
+  size_t m_downloads_outstanding{ };
+  uint64_t m_exhaustion_events{ };
+  bool m_exhausted{ };
+  const bool m_targets_exhausted_event;
   bool m_video_requested{ true };
+  uint64_t m_downloads_started{ };
+  std::unique_ptr<CpuTimeline> m_downloaded_timeline;
+  // downloads in the order they started, completed ones are removed from the front
+  std::deque<Download> m_download_order;
+};
+
+//-------------------------------------------------------------------------
+
+// recycles the plane buffers of video frames. the buffers are returned to
+// the pool when the host calls the OnComplete of the frame. they are 64 byte
+// aligned and their rows are padded to a multiple of 64 bytes.
+class FramePool {
+private:
+  struct Buffer;
+  struct State;
+
+public:
+  static constexpr size_t alignment = 64;
+
+  struct PlaneSize {
+    size_t row_size;
+    size_t rows;
+  };
+
+  struct Stats {
+    uint64_t buffers_allocated;
+    size_t buffers_alive;
+    size_t buffers_free;
+  };
+
+  // the buffers of one frame, returned to the pool when destroyed
+  class Buffers {
+  public:
+    Buffers() = default;
+    Buffers(Buffers&& rhs) noexcept
+      : m_state(std::move(rhs.m_state)),
+        m_first(std::exchange(rhs.m_first, nullptr)) {
+    }
+    Buffers& operator=(Buffers&& rhs) noexcept {
+      auto tmp = std::move(rhs);
+      std::swap(m_state, tmp.m_state);
+      std::swap(m_first, tmp.m_first);
+      return *this;
+    }
+    ~Buffers() {
+      if (m_state)
+        m_state->release(m_first);
+    }
+
+    size_t plane_count() const {
+      auto count = size_t{ };
+      for (auto buffer = m_first; buffer; buffer = buffer->next)
+        ++count;
+      return count;
+    }
+    uint8_t* data(size_t plane) const { return get(plane).data(); }
+    size_t pitch(size_t plane) const { return get(plane).pitch; }
+    BufferDesc plane(size_t plane) const {
+      const auto& buffer = get(plane);
+      return { buffer.data(), buffer.pitch * buffer.rows, buffer.pitch };
+    }
+
+    // the returned callback keeps the buffers until it is called or destroyed
+    OnComplete release_on_complete() {
+      return [buffers = std::move(*this)]() mutable noexcept { buffers = { }; };
+    }
+
+  private:
+    friend class FramePool;
+
+    Buffers(std::shared_ptr<State> state, Buffer* first)
+      : m_state(std::move(state)), m_first(first) {
+    }
+
+    const Buffer& get(size_t plane) const {
+      auto buffer = m_first;
+      while (plane--)
+        buffer = buffer->next;
+      return *buffer;
+    }
+
+    std::shared_ptr<State> m_state;
+    Buffer* m_first{ };
+  };
+
+  explicit FramePool(size_t max_free_buffers = 16)
+    : m_state(std::make_shared<State>(max_free_buffers)) {
+  }
+
+  Buffers acquire(std::initializer_list<PlaneSize> planes) {
+    // returns the buffers of the previous planes, when an allocation throws
+    auto buffers = Buffers(m_state, nullptr);
+    auto last = static_cast<Buffer*>(nullptr);
+    for (const auto& plane : planes) {
+      const auto pitch = (plane.row_size + alignment - 1) / alignment * alignment;
+      auto buffer = m_state->acquire(pitch, plane.rows);
+      (last ? last->next : buffers.m_first) = buffer;
+      last = buffer;
+    }
+    return buffers;
+  }
+
+  Stats stats() const {
+    auto lock = std::lock_guard(m_state->mutex);
+    return { m_state->buffers_allocated, m_state->buffers_alive, m_state->free_count };
+  }
+
+private:
+  // header in front of the data, which is followed by the next plane's buffer
+  struct alignas(alignment) Buffer {
+    size_t pitch;
+    size_t rows;
+    Buffer* next;
+
+    uint8_t* data() const {
+      return reinterpret_cast<uint8_t*>(const_cast<Buffer*>(this + 1));
+    }
+  };
+
+  struct State {
+    explicit State(size_t max_free) : max_free(max_free) { }
+    State(const State&) = delete;
+    State& operator=(const State&) = delete;
+    ~State() {
+      while (free)
+        destroy(std::exchange(free, free->next));
+    }
+
+    // reuses a free buffer of the same size, preferring recently returned ones
+    Buffer* acquire(size_t pitch, size_t rows) {
+      auto lock = std::unique_lock(mutex);
+      for (auto link = &free; *link; link = &(*link)->next)
+        if ((*link)->pitch == pitch && (*link)->rows == rows) {
+          auto buffer = std::exchange(*link, (*link)->next);
+          buffer->next = nullptr;
+          --free_count;
+          return buffer;
+        }
+      lock.unlock();
+
+      auto memory = ::operator new(sizeof(Buffer) + pitch * rows, std::align_val_t{ alignment });
+      lock.lock();
+      ++buffers_allocated;
+      ++buffers_alive;
+      return new (memory) Buffer{ pitch, rows, nullptr };
+    }
+
+    // buffers of sizes no longer acquired age out, once more than max_free are returned
+    void release(Buffer* buffers) noexcept {
+      auto lock = std::unique_lock(mutex);
+      while (buffers) {
+        auto buffer = std::exchange(buffers, buffers->next);
+        buffer->next = std::exchange(free, buffer);
+        ++free_count;
+      }
+      auto evicted = static_cast<Buffer*>(nullptr);
+      if (free_count > max_free) {
+        auto link = &free;
+        for (auto i = size_t{ }; i < max_free; ++i)
+          link = &(*link)->next;
+        evicted = std::exchange(*link, nullptr);
+        buffers_alive -= (free_count - max_free);
+        free_count = max_free;
+      }
+      lock.unlock();
+
+      while (evicted)
+        destroy(std::exchange(evicted, evicted->next));
+    }
+
+    void destroy(Buffer* buffer) noexcept {
+      buffer->~Buffer();
+      ::operator delete(buffer, std::align_val_t{ alignment });
+    }
+
+    std::mutex mutex;
+    const size_t max_free;
+    Buffer* free{ };
+    size_t free_count{ };
+    uint64_t buffers_allocated{ };
+    size_t buffers_alive{ };
+  };
+
+  std::shared_ptr<State> m_state;
 };
 
 } // namespace
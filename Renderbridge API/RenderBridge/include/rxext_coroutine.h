@@ -0,0 +1,260 @@
+#pragma once
+
+#include "rxext_client.h"
+#include <array>
+#include <coroutine>
+#include <exception>
+#include <mutex>
+
+#if !defined(__cpp_impl_coroutine)
+#  error "rxext_coroutine.h requires C++20 coroutine support"
+#endif
+
+namespace rxext {
+
+// recycles the memory of coroutine frames in size classes,
+// a frame can be freed on another thread than it was allocated on
+class CoroutineFramePool {
+public:
+  struct Stats {
+    uint64_t frames_allocated;
+    uint64_t frames_reused;
+    size_t frames_free;
+  };
+
+  static CoroutineFramePool& instance() {
+    static auto pool = CoroutineFramePool();
+    return pool;
+  }
+
+  CoroutineFramePool() = default;
+  CoroutineFramePool(const CoroutineFramePool&) = delete;
+  CoroutineFramePool& operator=(const CoroutineFramePool&) = delete;
+  ~CoroutineFramePool() {
+    for (auto& free : m_free)
+      while (free)
+        ::operator delete(std::exchange(free, free->next));
+  }
+
+  void* allocate(size_t size) {
+    const auto size_class = get_size_class(size);
+    if (size_class >= size_class_count)
+      return ::operator new(size);
+
+    auto lock = std::unique_lock(m_mutex);
+    if (auto frame = m_free[size_class]) {
+      m_free[size_class] = frame->next;
+      --m_frames_free;
+      ++m_frames_reused;
+      return frame;
+    }
+    ++m_frames_allocated;
+    lock.unlock();
+    return ::operator new((size_class + 1) * granularity);
+  }
+
+  void deallocate(void* memory, size_t size) noexcept {
+    const auto size_class = get_size_class(size);
+    if (size_class >= size_class_count)
+      return ::operator delete(memory);
+
+    auto lock = std::lock_guard(m_mutex);
+    auto frame = static_cast<FreeFrame*>(memory);
+    frame->next = std::exchange(m_free[size_class], frame);
+    ++m_frames_free;
+  }
+
+  Stats stats() const {
+    auto lock = std::lock_guard(m_mutex);
+    return { m_frames_allocated, m_frames_reused, m_frames_free };
+  }
+
+private:
+  static constexpr size_t granularity = 64;
+  static constexpr size_t size_class_count = 64;
+
+  struct FreeFrame {
+    FreeFrame* next;
+  };
+
+  static size_t get_size_class(size_t size) {
+    return (std::max(size, size_t{ 1 }) - 1) / granularity;
+  }
+
+  mutable std::mutex m_mutex;
+  std::array<FreeFrame*, size_class_count> m_free{ };
+  uint64_t m_frames_allocated{ };
+  uint64_t m_frames_reused{ };
+  size_t m_frames_free{ };
+};
+
+// coroutine, which starts immediately and is destroyed when it completes.
+// the function arguments are copied to the frame, so pass owned values.
+// when the host destroys a callback without calling it, e.g. on shutdown or
+// when a stream is released, the coroutine is destroyed at the co_await.
+// only the destructors of its locals run, not the code after it.
+class Task {
+public:
+  struct promise_type {
+    Task get_return_object() noexcept { return { }; }
+    std::suspend_never initial_suspend() noexcept { return { }; }
+    std::suspend_never final_suspend() noexcept { return { }; }
+    void return_void() noexcept { }
+    void unhandled_exception() noexcept { std::terminate(); }
+
+    static void* operator new(size_t size) {
+      return CoroutineFramePool::instance().allocate(size);
+    }
+    static void operator delete(void* memory, size_t size) noexcept {
+      CoroutineFramePool::instance().deallocate(memory, size);
+    }
+  };
+};
+
+namespace detail {
+  // owned by the callback, destroys the coroutine when the callback is
+  // destroyed without being called
+  class ResumeGuard {
+  public:
+    explicit ResumeGuard(std::coroutine_handle<> handle) noexcept : m_handle(handle) { }
+    ResumeGuard(ResumeGuard&& rhs) noexcept : m_handle(std::exchange(rhs.m_handle, nullptr)) { }
+    ResumeGuard& operator=(ResumeGuard&&) = delete;
+    ~ResumeGuard() {
+      if (m_handle)
+        m_handle.destroy();
+    }
+
+    void resume() noexcept { std::exchange(m_handle, nullptr).resume(); }
+
+  private:
+    std::coroutine_handle<> m_handle;
+  };
+
+  // resumes the coroutine in the callback of a host function,
+  // the callback only captures the awaiter and the handle, so it fits into the function object
+  template<typename Result>
+  class HostAwaiter {
+  public:
+    bool await_ready() const noexcept { return false; }
+    Result await_resume() noexcept { return std::move(m_result); }
+
+  protected:
+    auto resume_callback(std::coroutine_handle<> handle) noexcept {
+      return [this, guard = ResumeGuard(handle)](auto result) mutable noexcept {
+        m_result = std::move(result);
+        guard.resume();
+      };
+    }
+
+    Result m_result{ };
+  };
+
+  template<>
+  class HostAwaiter<void> {
+  public:
+    bool await_ready() const noexcept { return false; }
+    void await_resume() noexcept { }
+
+  protected:
+    auto resume_callback(std::coroutine_handle<> handle) noexcept {
+      return [guard = ResumeGuard(handle)]() mutable noexcept { guard.resume(); };
+    }
+  };
+} // namespace
+
+// continues on a host thread after the delay
+inline auto delay(HostContext host, std::chrono::duration<double> duration) {
+  class Awaiter : public detail::HostAwaiter<void> {
+  public:
+    Awaiter(HostContext host, std::chrono::duration<double> delay)
+      : m_host(host), m_delay(delay) { }
+
+    void await_suspend(std::coroutine_handle<> handle) noexcept {
+      m_host.set_timeout(m_delay, resume_callback(handle));
+    }
+
+  private:
+    HostContext m_host;
+    std::chrono::duration<double> m_delay;
+  };
+  return Awaiter(host, duration);
+}
+
+// continues on a thread selected by the policy
+inline auto resume_on(HostContext host, AsyncPolicy policy) {
+  class Awaiter : public detail::HostAwaiter<void> {
+  public:
+    Awaiter(HostContext host, AsyncPolicy policy)
+      : m_host(host), m_policy(policy) { }
+
+    void await_suspend(std::coroutine_handle<> handle) noexcept {
+      m_host.async(m_policy, resume_callback(handle));
+    }
+
+  private:
+    HostContext m_host;
+    AsyncPolicy m_policy;
+  };
+  return Awaiter(host, policy);
+}
+
+// returns the texture's data, which is only valid until the coroutine suspends again
+inline auto download(HostContext host, TextureRef texture) {
+  class Awaiter : public detail::HostAwaiter<BufferDesc> {
+  public:
+    Awaiter(HostContext host, TextureRef texture)
+      : m_host(host), m_texture(std::move(texture)) { }
+
+    void await_suspend(std::coroutine_handle<> handle) noexcept {
+      m_host.download_texture(std::move(m_texture), resume_callback(handle));
+    }
+
+  private:
+    HostContext m_host;
+    TextureRef m_texture;
+  };
+  return Awaiter(host, std::move(texture));
+}
+
+// the buffer needs to stay valid until the coroutine continues, unless upload_copy is set
+inline auto upload(HostContext host, TextureRef texture,
+    const BufferDesc& buffer, bool upload_copy) {
+  class Awaiter : public detail::HostAwaiter<void> {
+  public:
+    Awaiter(HostContext host, TextureRef texture, const BufferDesc& buffer, bool upload_copy)
+      : m_host(host), m_texture(std::move(texture)),
+        m_buffer(buffer), m_upload_copy(upload_copy) { }
+
+    void await_suspend(std::coroutine_handle<> handle) noexcept {
+      m_host.upload_texture(std::move(m_texture), m_buffer, m_upload_copy,
+        resume_callback(handle));
+    }
+
+  private:
+    HostContext m_host;
+    TextureRef m_texture;
+    BufferDesc m_buffer;
+    bool m_upload_copy;
+  };
+  return Awaiter(host, std::move(texture), buffer, upload_copy);
+}
+
+// the frame's data needs to stay valid until the coroutine continues
+inline auto unpack(HostContext host, const VideoFrame& frame) {
+  class Awaiter : public detail::HostAwaiter<vector<TextureRef>> {
+  public:
+    Awaiter(HostContext host, const VideoFrame& frame)
+      : m_host(host), m_frame(frame) { }
+
+    void await_suspend(std::coroutine_handle<> handle) noexcept {
+      m_host.unpack_video_frame(m_frame, resume_callback(handle));
+    }
+
+  private:
+    HostContext m_host;
+    const VideoFrame& m_frame;
+  };
+  return Awaiter(host, frame);
+}
+
+} // namespace
@@ -1,10 +1,16 @@
 #pragma once
 
 #include "rxext.h"
+#include <algorithm>
+#include <any>
+#include <charconv>
+#include <deque>
 #include <string>
 #include <vector>
 #include <sstream>
 #include <chrono>
+#include <tuple>
+#include <unordered_map>
 
 namespace rxext {
 
@@ -22,6 +28,125 @@ inline bool operator!=(const NamedValue& a, const NamedValue& b) {
   return !(a == b); 
 }
 
+namespace detail {
+  template<typename T> 
+  constexpr bool is_char_v = std::is_same_v<T, char> || std::is_same_v<T, signed char> ||
+    std::is_same_v<T, unsigned char> || std::is_same_v<T, wchar_t> ||
+    std::is_same_v<T, char16_t> || std::is_same_v<T, char32_t>;
+
+  // types which are converted using charconv, with a fallback to iostreams
+  template<typename T>
+  constexpr bool has_charconv_v = std::is_same_v<T, bool> || 
+    (std::is_integral_v<T> && !is_char_v<T>)
+#if defined(__cpp_lib_to_chars)
+    || std::is_floating_point_v<T>
+#endif
+    ;
+
+  // returns false when the string should be parsed by an istream,
+  // which also accepts leading whitespace, '+', trailing characters...
+  template<typename T>
+  bool charconv_to_value(std::string_view str, T& value) {
+    if constexpr (std::is_same_v<T, bool>) {
+      if (str == "true" || str == "false") {
+        value = (str.front() == 't');
+        return true;
+      }
+      return false;
+    }
+    else {
+      const auto digits = str.substr(!str.empty() && str.front() == '-' ? 1 : 0);
+      if (digits.empty() || !((digits.front() >= '0' && digits.front() <= '9') ||
+                              (std::is_floating_point_v<T> && digits.front() == '.')))
+        return false;
+      const auto end = str.data() + str.size();
+      const auto [ptr, ec] = std::from_chars(str.data(), end, value);
+      return (ec == std::errc{ } && ptr == end);
+    }
+  }
+
+  // appends the same characters an ostream would
+  template<typename T>
+  void charconv_append(std::string& str, T value) {
+    if constexpr (std::is_same_v<T, bool>) {
+      str += (value ? "true" : "false");
+    }
+    else {
+      char buffer[64];
+      const auto end = buffer + sizeof(buffer);
+      if constexpr (std::is_floating_point_v<T>) {
+        // default ostream precision
+        str.append(buffer, std::to_chars(buffer, end, value, std::chars_format::general, 6).ptr);
+      }
+      else {
+        str.append(buffer, std::to_chars(buffer, end, value).ptr);
+      }
+    }
+  }
+
+  template<typename T>
+  T stream_to_value(std::string_view str) {
+    if constexpr (is_vector<T>::value) {
+      // vector<E>
+      using E = typename T::value_type;
+      auto ss = std::istringstream(std::string(str));
+      ss >> std::boolalpha;
+      auto value = T{ };
+      auto element = E{ };
+      while (ss.good()) {
+        if constexpr (std::is_same_v<E, std::string> || std::is_same_v<E, string>) {
+          // vector<string>
+          for (;;) {
+            const auto c = ss.get();
+            if (!ss.good())
+              break;
+            if (value.empty())
+              value.emplace_back();
+            if (c == '\v')  
+              value.emplace_back();
+            else
+              value.back().push_back(static_cast<char>(c));
+          } 
+        }
+        else {
+          // vector<E>
+          ss.peek();
+          if (ss.good()) {
+            ss >> element;
+            value.push_back(element);
+          }
+          ss.get();
+        }
+      }
+      return value;
+    }
+    else {
+      auto value = T{ };
+      auto ss = std::istringstream(std::string(str));
+      ss >> std::boolalpha >> value;
+      return value;
+    }
+  }
+
+  template<typename T>
+  std::string value_to_stream_string(const T& value) {
+    auto ss = std::ostringstream();
+    ss << std::boolalpha;
+    if constexpr (is_vector<T>::value) {
+      auto first = true;
+      for (const auto& element : value) {
+        if (!std::exchange(first, false))
+          ss.put('\v');
+        ss << element;
+      }
+    }
+    else {
+      ss << value;
+    }
+    return std::move(ss).str();
+  }
+} // namespace
+
 template<typename T, typename S>
 T string_to_value(S&& str) {
   if constexpr (std::is_same_v<T, string>) {
@@ -33,70 +158,70 @@ T string_to_value(S&& str) {
   else if constexpr (detail::is_vector<std::decay_t<T>>::value) {
     // vector<E>
     using E = typename T::value_type;
-    auto ss = std::istringstream({ str.begin(), str.end() });
-    ss >> std::boolalpha;
-    auto value = T{ };
-    auto element = E{ };
-    while (ss.good()) {
-      if constexpr (std::is_same_v<E, std::string> || std::is_same_v<E, string>) {
-        // vector<string>
-        for (;;) {
-          const auto c = ss.get();
-          if (!ss.good())
-            break;
-          if (value.empty())
-            value.emplace_back();
-          if (c == '\v')  
-            value.emplace_back();
-          else
-            value.back().push_back(static_cast<char>(c));
-        } 
-      }
-      else {
-        // vector<E>
-        ss.peek();
-        if (ss.good()) {
-          ss >> element;
+    const auto view = std::string_view(str.data(), str.size());
+    if constexpr (detail::has_charconv_v<E>) {
+      // elements are separated by '\v', empty elements are skipped
+      auto value = T{ };
+      auto element = E{ };
+      for (auto begin = size_t{ }; begin < view.size(); ) {
+        const auto end = std::min(view.find('\v', begin), view.size());
+        if (end != begin) {
+          if (!detail::charconv_to_value(view.substr(begin, end - begin), element))
+            return detail::stream_to_value<T>(view);
           value.push_back(element);
         }
-        ss.get();
+        begin = end + 1;
       }
+      return value;
+    }
+    else {
+      return detail::stream_to_value<T>(view);
     }
-    return value;
   }
   else {
-    auto value = T{ };
-    auto ss = std::istringstream(str.c_str());
-    ss >> std::boolalpha >> value;
-    return value;
+    const auto view = std::string_view(str.data(), str.size());
+    if constexpr (detail::has_charconv_v<T>) {
+      auto value = T{ };
+      if (detail::charconv_to_value(view, value))
+        return value;
+    }
+    return detail::stream_to_value<T>(view);
   }
 }
 
 template<typename T>
 string value_to_string(T&& value) {
-  if constexpr (std::is_same_v<std::decay_t<T>, string>) {
+  using V = std::decay_t<T>;
+  if constexpr (std::is_same_v<V, string>) {
     return std::forward<T>(value);
   }
-  else if constexpr (std::is_same_v<std::decay_t<T>, std::string>) {
+  else if constexpr (std::is_same_v<V, std::string>) {
     return { value.begin(), value.end() };
   }
-  else if constexpr (detail::is_vector<std::decay_t<T>>::value) {
+  else if constexpr (detail::is_vector<V>::value) {
     // vector<E>
-    auto ss = std::ostringstream();
-    ss << std::boolalpha;
-    auto first = true;
-    for (const auto& element : value) {
-      if (!std::exchange(first, false))
-        ss.put('\v');
-      ss << element;
+    if constexpr (detail::has_charconv_v<typename V::value_type>) {
+      auto str = std::string();
+      auto first = true;
+      for (const auto& element : value) {
+        if (!std::exchange(first, false))
+          str.push_back('\v');
+        detail::charconv_append<typename V::value_type>(str, element);
+      }
+      return { str.begin(), str.end() };
     }
-    const auto str = std::move(ss).str();
+    else {
+      const auto str = detail::value_to_stream_string(value);
+      return { str.begin(), str.end() };
+    }
+  }
+  else if constexpr (detail::has_charconv_v<V>) {
+    auto str = std::string();
+    detail::charconv_append(str, value);
     return { str.begin(), str.end() };
   }
   else {
-    auto ss = std::ostringstream();
-    ss << std::boolalpha << value;
-    const auto str = std::move(ss).str();
+    const auto str = detail::value_to_stream_string(value);
     return { str.begin(), str.end() };
   }
 }
@@ -124,6 +249,170 @@ inline bool operator!=(const ValueSet& a, const ValueSet& b) { return (a.values
 
 //-------------------------------------------------------------------------
 
+// 64 bit FNV-1a hash, which can be evaluated at compile time
+constexpr uint64_t hash_name(string_view name) {
+  auto hash = uint64_t{ 14695981039346656037ull };
+  for (auto c : name) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+// name with its hash, which is computed at compile time for constant names.
+// It converts to the hash, so names can be dispatched using switch. Only the
+// hashes are compared then, so each case needs to confirm the name using is:
+//   const auto atom = Atom(name);
+//   switch (atom) {
+//     case Atom(PropertyNames::shader_file):
+//       if (atom.is(PropertyNames::shader_file)) ...
+//       break;
+//   }
+// Atom::Equal also compares the names.
+class Atom {
+public:
+  struct Hash {
+    size_t operator()(const Atom& atom) const { return static_cast<size_t>(atom.hash()); }
+  };
+  struct Equal {
+    bool operator()(const Atom& a, const Atom& b) const {
+      return (a.hash() == b.hash() && a.name() == b.name()); 
+    }
+  };
+
+  constexpr Atom() = default;
+  constexpr Atom(const char* name) : Atom(string_view(name)) { }
+  constexpr Atom(string_view name) : m_name(name), m_hash(hash_name(name)) { }
+  Atom(const std::string& name) : Atom(string_view(name)) { }
+  Atom(const string& name) : Atom(string_view(name.data(), name.size())) { }
+
+  constexpr string_view name() const { return m_name; }
+  constexpr uint64_t hash() const { return m_hash; }
+  constexpr bool is(string_view name) const { return (m_name == name); }
+  constexpr operator uint64_t() const { return m_hash; }
+
+private:
+  string_view m_name;
+  uint64_t m_hash{ hash_name({ }) };
+};
+
+//-------------------------------------------------------------------------
+
+// ValueSet with hashed names, which keeps the typed values alongside the strings.
+// Values are only parsed once per type and only formatted when converted to a 
+// ValueSet. Names are passed as Atom, so the hashes of constant names are 
+// computed at compile time. It is not thread safe, since get updates the cached values.
+class IndexedValueSet {
+public:
+  IndexedValueSet() = default;
+  explicit IndexedValueSet(const ValueSet& value_set) {
+    for (const auto& value : value_set.values)
+      set(value.name, value.value);
+  }
+  IndexedValueSet(const IndexedValueSet& rhs)
+    : m_entries(rhs.m_entries) {
+    update_index();
+  }
+  IndexedValueSet& operator=(const IndexedValueSet& rhs) {
+    m_entries = rhs.m_entries;
+    update_index();
+    return *this;
+  }
+  IndexedValueSet(IndexedValueSet&& rhs) = default;
+  IndexedValueSet& operator=(IndexedValueSet&& rhs) = default;
+
+  size_t size() const { return m_entries.size(); }
+  bool contains(Atom name) const { return (find(name) != nullptr); }
+
+  template<typename T = std::string>
+  T get(Atom name, T default_value = T{ }) const {
+    const auto entry = find(name);
+    if (!entry)
+      return default_value;
+    if (auto value = std::any_cast<T>(&entry->value))
+      return *value;
+    auto value = string_to_value<T>(entry_text(*entry));
+    entry->value = value;
+    return value;
+  }
+
+  std::string get(Atom name, const char* default_value) const {
+    return get<std::string>(name, default_value);
+  }
+
+  template<typename T>
+  void set(Atom name, const T& value) {
+    auto entry = find(name);
+    if (!entry) {
+      auto& added = m_entries.emplace_back();
+      added.name = std::string(name.name());
+      m_index.emplace(Atom(added.name), &added);
+      entry = &added;
+    }
+    if constexpr (std::is_same_v<T, string>) {
+      entry->text = value;
+      entry->value.reset();
+      entry->format = nullptr;
+    }
+    else {
+      entry->value = value;
+      entry->format = &format<T>;
+    }
+  }
+
+  void set(Atom name, const char* value) {
+    set(name, string(value));
+  }
+
+  // converts to the form which is passed through the interface
+  ValueSet value_set() const {
+    auto value_set = ValueSet();
+    value_set.values.reserve(m_entries.size());
+    for (const auto& entry : m_entries)
+      value_set.values.emplace_back(entry.name, entry_text(entry));
+    return value_set;
+  }
+
+private:
+  struct Entry {
+    std::string name;
+    // text is outdated while format is set
+    mutable string text;
+    mutable std::any value;
+    mutable string (*format)(const std::any& value){ };
+  };
+
+  template<typename T>
+  static string format(const std::any& value) {
+    return value_to_string(std::any_cast<const T&>(value));
+  }
+
+  static const string& entry_text(const Entry& entry) {
+    if (entry.format) {
+      entry.text = entry.format(entry.value);
+      entry.format = nullptr;
+    }
+    return entry.text;
+  }
+
+  Entry* find(Atom name) const {
+    const auto it = m_index.find(name);
+    return (it != m_index.end() ? it->second : nullptr);
+  }
+
+  void update_index() {
+    m_index.clear();
+    for (auto& entry : m_entries)
+      m_index.emplace(Atom(entry.name), &entry);
+  }
+
+  // deque keeps the names referenced by the index in place
+  std::deque<Entry> m_entries;
+  std::unordered_map<Atom, Entry*, Atom::Hash, Atom::Equal> m_index;
+};
+
+//-------------------------------------------------------------------------
+
 #define RXEXT_ADD_EACH_FORMAT \
   X(R8_UNORM) \
   X(R8G8_UNORM) \
@@ -160,6 +449,32 @@ inline string_view get_format_name(Format format) {
 
 //-------------------------------------------------------------------------
 
+// returns whether a version "major.minor" is at least the required version,
+// function table entries which were added later must not be called otherwise
+inline bool is_api_version_supported(string_view version, int major, int minor) {
+  const auto parse_number = [&]() {
+    auto value = 0;
+    while (!version.empty() && version.front() >= '0' && version.front() <= '9') {
+      value = value * 10 + (version.front() - '0');
+      version.remove_prefix(1);
+    }
+    if (!version.empty())
+      version.remove_prefix(1);
+    return value;
+  };
+  const auto version_major = parse_number();
+  const auto version_minor = parse_number();
+  return std::tie(version_major, version_minor) >= std::tie(major, minor);
+}
+
+// returns the current time in the clock of FrameTimestamps::capture_time_ns
+inline int64_t get_timestamp_ns() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+//-------------------------------------------------------------------------
+
 template<typename T>
 class PtrBase {
 public:
@@ -341,6 +656,14 @@ namespace SettingNames {
   RXEXT_ADD(format);
   RXEXT_ADD(sync_group);
   RXEXT_ADD(layer_id);
+  RXEXT_ADD(frame_queue_depth);
+  RXEXT_ADD(frame_drop_policy);
+  RXEXT_ADD(target_pool_size);
+  RXEXT_ADD(target_latency_ms);
+  RXEXT_ADD(cpu_timeline);
+  RXEXT_ADD(targets_exhausted_event);
+  RXEXT_ADD(monitor_id);
+  RXEXT_ADD(trace_file);
 }
 
 namespace StateNames {
@@ -355,6 +678,10 @@ namespace StateNames {
   RXEXT_ADD(scale_y);
   RXEXT_ADD(audio_channel_count);
   RXEXT_ADD(audio_sample_rate);
+  RXEXT_ADD(target_pool_size);
+  RXEXT_ADD(downloads_outstanding);
+  RXEXT_ADD(target_pool_exhaustions);
+  RXEXT_ADD(oldest_download_ms);
 }
 
 namespace ParameterNames {
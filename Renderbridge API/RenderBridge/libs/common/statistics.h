@@ -3,22 +3,159 @@
 #include <algorithm>
 #include <array>
 #include <cmath>
+#include <functional>
 #include <numeric>
 #include <tuple>
+#include <type_traits>
 #include <vector>
 #include <cfloat>
+#include <cstdint>
+#include <limits>
 #include <ostream>
 #include <iterator>
+#include <stdexcept>
 #include "common/to_double.h"
 
+#if defined(_MSC_VER)
+#  include <intrin.h>
+#endif
+
 namespace common {
 
-template<typename T>
+namespace detail {
+  // vector interface on a fixed array, to keep samples without heap allocations
+  template<typename T, size_t Capacity>
+  class FixedVector {
+  public:
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    void reserve(size_t capacity) {
+      if (capacity > Capacity)
+        throw std::length_error("capacity exceeds fixed capacity");
+      m_capacity = capacity;
+    }
+    size_t size() const { return m_size; }
+    size_t capacity() const { return m_capacity; }
+    bool empty() const { return !m_size; }
+    void clear() { m_size = 0; }
+
+    template<typename... Args>
+    void emplace_back(Args&&... args) {
+      m_data[m_size++] = T{ std::forward<Args>(args)... };
+    }
+    template<typename It>
+    void insert(iterator, It begin, It end) {
+      m_size = static_cast<size_t>(std::copy(begin, end, this->end()) - m_data.data());
+    }
+
+    T& operator[](size_t index) { return m_data[index]; }
+    const T& operator[](size_t index) const { return m_data[index]; }
+    iterator begin() { return m_data.data(); }
+    iterator end() { return m_data.data() + m_size; }
+    const_iterator begin() const { return m_data.data(); }
+    const_iterator end() const { return m_data.data() + m_size; }
+
+  private:
+    std::array<T, Capacity> m_data{ };
+    size_t m_size{ };
+    size_t m_capacity{ Capacity };
+  };
+
+  // ring of the candidates for the extreme of the last window values, ordered by
+  // age. each value is added and removed once, so push is amortized O(1).
+  // Compare is std::less for the minimum and std::greater for the maximum.
+  template<typename T, size_t Capacity, typename Compare>
+  class MonotonicWindow {
+  public:
+    explicit MonotonicWindow(size_t window) : m_window(std::max(window, size_t(1))) {
+      if constexpr (Capacity == 0)
+        m_entries.resize(m_window);
+      else if (m_window > Capacity)
+        throw std::length_error("capacity exceeds fixed capacity");
+    }
+
+    bool empty() const { return !m_size; }
+    const T& front() const { return m_entries[m_front].value; }
+
+    void clear() {
+      m_front = 0;
+      m_size = 0;
+    }
+
+    void push(uint64_t sequence, const T& value) {
+      while (m_size && m_entries[m_front].sequence + m_window <= sequence) {
+        m_front = (m_front + 1) % m_window;
+        --m_size;
+      }
+      while (m_size && !Compare()(m_entries[(m_front + m_size - 1) % m_window].value, value))
+        --m_size;
+      m_entries[(m_front + m_size) % m_window] = { sequence, value };
+      ++m_size;
+    }
+
+  private:
+    struct Entry {
+      uint64_t sequence;
+      T value;
+    };
+    using Entries = std::conditional_t<Capacity == 0, 
+      std::vector<Entry>, std::array<Entry, Capacity>>;
+
+    size_t m_window;
+    Entries m_entries{ };
+    size_t m_front{ };
+    size_t m_size{ };
+  };
+
+  // weight, mean and central moments of a range, computed in two passes 
+  // with independent accumulators, so the loops can be vectorized
+  struct Moments {
+    double weight;
+    double mean;
+    double m2;
+    double m3;
+
+    template<typename T>
+    static Moments of(const T* values, size_t count) {
+      if (!count)
+        return { };
+      double sum[4] = { };
+      auto i = size_t{ };
+      for (; i + 4 <= count; i += 4)
+        for (auto j = 0; j < 4; ++j)
+          sum[j] += to_double(values[i + j]);
+      for (; i < count; ++i)
+        sum[0] += to_double(values[i]);
+      const auto mean = (sum[0] + sum[1] + sum[2] + sum[3]) / static_cast<double>(count);
+
+      double m2[4] = { }, m3[4] = { };
+      for (i = 0; i + 4 <= count; i += 4)
+        for (auto j = 0; j < 4; ++j) {
+          const auto d = to_double(values[i + j]) - mean;
+          m2[j] += d * d;
+          m3[j] += d * d * d;
+        }
+      for (; i < count; ++i) {
+        const auto d = to_double(values[i]) - mean;
+        m2[0] += d * d;
+        m3[0] += d * d * d;
+      }
+      return { static_cast<double>(count), mean, 
+        m2[0] + m2[1] + m2[2] + m2[3], m3[0] + m3[1] + m3[2] + m3[3] };
+    }
+  };
+} // namespace
+
+// keeps the last capacity samples, in a vector or, with Capacity set,
+// in a fixed array of which up to capacity samples are used
+template<typename T, size_t Capacity = 0>
 class SampleCache {
 public:
-  using Buffer = std::vector<T>;
+  using Buffer = std::conditional_t<Capacity == 0, 
+    std::vector<T>, detail::FixedVector<T, Capacity>>;
 
-  explicit SampleCache(size_t capacity) {
+  explicit SampleCache(size_t capacity = std::max(Capacity, size_t(1))) {
     m_buffer.reserve(std::max(capacity, size_t(1)));
   }
   size_t size() const { return m_buffer.size(); }
@@ -26,6 +163,7 @@ public:
   bool empty() const { return m_buffer.empty(); }
   bool filled() const { return size() == capacity(); }
 
+  // returns the replaced sample, once filled
   template<typename... Args>
   T push(Args&&... args) {
     if (!filled()) {
@@ -34,19 +172,44 @@ public:
       return T();
     }
 
-    T replaced{ std::forward<Args>(args)... };
-    std::swap(m_buffer[m_index % m_buffer.size()], replaced);
-    ++m_index;
+    auto& sample = m_buffer[m_index++ % m_buffer.size()];
+    auto replaced = std::move(sample);
+    sample = T{ std::forward<Args>(args)... };
     return replaced;
   }
 
+  // pushes the values in contiguous ranges. calls on_push(added, replaced, count)
+  // for each range, before it is copied, replaced is null while not filled.
+  template<typename F>
+  void push(const T* values, size_t count, F&& on_push) {
+    if (!filled() && count) {
+      const auto added = std::min(count, capacity() - size());
+      on_push(values, static_cast<const T*>(nullptr), added);
+      m_buffer.insert(m_buffer.end(), values, values + added);
+      m_index += added;
+      values += added;
+      count -= added;
+    }
+    while (count) {
+      const auto position = m_index % m_buffer.size();
+      const auto replaced = std::min(count, m_buffer.size() - position);
+      on_push(values, static_cast<const T*>(&m_buffer[position]), replaced);
+      std::copy(values, values + replaced, &m_buffer[position]);
+      m_index += replaced;
+      values += replaced;
+      count -= replaced;
+    }
+  }
+
   void reset() {
     m_buffer.clear();
+    m_index = 0;
   }
 
   void reset(size_t capacity) {
     m_buffer = Buffer();
     m_buffer.reserve(capacity);
+    m_index = 0;
   }
 
   auto begin() -> typename Buffer::iterator { return m_buffer.begin(); }
@@ -58,31 +221,57 @@ private:
   Buffer m_buffer;
   size_t m_index{ };
 };
-  
-template<typename T>
+
+// statistics of the last capacity samples. min and max are O(1),
+// with Capacity set no memory is allocated.
+template<typename T, size_t Capacity = 0>
 class WindowedStatistic {
 public:
-  explicit WindowedStatistic(size_t capacity) 
-    : m_samples(capacity) {
+  explicit WindowedStatistic(size_t capacity = std::max(Capacity, size_t(1))) 
+    : m_samples(capacity), m_min(m_samples.capacity()), m_max(m_samples.capacity()) {
   }
   bool initialized() const { 
     return m_samples.filled(); 
   }
   void reset() {
-    *this = WindowedStatistic(m_samples.capacity());
+    m_samples.reset();
+    m_min.clear();
+    m_max.clear();
+    m_sequence = 0;
+    m_mean = m_skew = m_variance = m_weight = 0;
   }
   size_t capacity() const { return m_samples.capacity(); }
   void push(const T& value) {
+    push_extremes(value);
     if (!m_samples.filled()) {
       m_samples.push(value);
       update(value, 1);
     } 
     else {
       auto removed = m_samples.push(value);
-      update(removed, -1);
       update(value, 1);
+      update(removed, -1);
     }
   }
+
+  // pushes multiple values, adding and removing the moments of contiguous ranges
+  void push(const T* values, size_t count) {
+    const auto skipped = (count > capacity() ? count - capacity() : 0);
+    m_sequence += skipped;
+    for (auto i = skipped; i < count; ++i)
+      push_extremes(values[i]);
+
+    m_samples.push(values, count, [&](const T* added, const T* replaced, size_t count) {
+      combine(detail::Moments::of(added, count), 1.0);
+      if (replaced)
+        combine(detail::Moments::of(replaced, count), -1.0);
+    });
+  }
+
+  void push(const std::vector<T>& values) {
+    push(values.data(), values.size());
+  }
+
   T mean() const { 
     return from_double<T>(m_mean);
   }
@@ -102,13 +291,19 @@ public:
     return T(variance != 0 ? m_skew * sqrt(m_weight / (variance * variance *  variance)) : 0.0);
   }
   T min() const {
-    return (!m_samples.empty() ? *std::min_element(m_samples.begin(), m_samples.end()) : T());
+    return (!m_min.empty() ? m_min.front() : T());
   }
   T max() const {
-    return (!m_samples.empty() ? *std::max_element(m_samples.begin(), m_samples.end()) : T());
+    return (!m_max.empty() ? m_max.front() : T());
   }
 
 private:
+  void push_extremes(const T& value) {
+    m_min.push(m_sequence, value);
+    m_max.push(m_sequence, value);
+    ++m_sequence;
+  }
+
   void update(const T& value, const double weight) {
     const auto data = to_double(value);
 
@@ -138,7 +333,42 @@ private:
     m_weight = tw;
   }
 
-  SampleCache<T> m_samples;
+  // adds (sign 1) or removes (sign -1) the moments of a range of samples
+  void combine(const detail::Moments& b, double sign) {
+    if (!b.weight)
+      return;
+    if (sign > 0) {
+      const auto na = m_weight;
+      const auto n = na + b.weight;
+      const auto delta = b.mean - m_mean;
+      m_mean += delta * b.weight / n;
+      m_skew += b.m3 + delta * delta * delta * na * b.weight * (na - b.weight) / (n * n) +
+        3.0 * delta * (na * b.m2 - b.weight * m_variance) / n;
+      m_variance += b.m2 + delta * delta * na * b.weight / n;
+      m_weight = n;
+    }
+    else {
+      const auto n = m_weight;
+      const auto na = n - b.weight;
+      if (na <= 0) {
+        m_mean = m_skew = m_variance = m_weight = 0;
+        return;
+      }
+      const auto mean_a = (n * m_mean - b.weight * b.mean) / na;
+      const auto delta = b.mean - mean_a;
+      const auto m2_a = m_variance - b.m2 - delta * delta * na * b.weight / n;
+      m_skew -= b.m3 + delta * delta * delta * na * b.weight * (na - b.weight) / (n * n) +
+        3.0 * delta * (na * b.m2 - b.weight * m2_a) / n;
+      m_variance = m2_a;
+      m_mean = mean_a;
+      m_weight = na;
+    }
+  }
+
+  SampleCache<T, Capacity> m_samples;
+  detail::MonotonicWindow<T, Capacity, std::less<T>> m_min;
+  detail::MonotonicWindow<T, Capacity, std::greater<T>> m_max;
+  uint64_t m_sequence{ };
   double m_mean{ };
   double m_skew{ };
   double m_variance{ };
@@ -288,6 +518,150 @@ private:
   size_t m_n{ };
 };
 
+namespace detail {
+  // index of the highest set bit, value must not be zero
+  inline int highest_bit(uint64_t value) {
+#if defined(_MSC_VER)
+    auto index = 0ul;
+    _BitScanReverse64(&index, value);
+    return static_cast<int>(index);
+#else
+    return 63 - __builtin_clzll(value);
+#endif
+  }
+} // namespace
+
+// histogram with logarithmic buckets (HDR-style), which records values in O(1) 
+// with a relative error of at most 2^-precision_bits, using fixed memory.
+// histograms with the same layout can be merged, e.g. ones recorded per thread.
+template<typename T>
+class Histogram {
+public:
+  // records values from zero to max_value in steps of resolution, larger values are clamped
+  Histogram(const T& resolution, const T& max_value, int precision_bits = 7)
+    : m_resolution(to_double(resolution)),
+      m_units_per_value(1.0 / m_resolution),
+      m_precision_bits(std::clamp(precision_bits, 1, 16)) {
+    if (!(m_resolution > 0))
+      throw std::invalid_argument("invalid histogram resolution");
+    m_max_units = static_cast<uint64_t>(std::clamp(to_double(max_value) / m_resolution, 
+      1.0, static_cast<double>(uint64_t{ 1 } << 62)));
+    m_counts.resize(bucket_index(m_max_units) + 1);
+  }
+
+  void push(const T& value) {
+    const auto data = to_double(value);
+    ++m_counts[bucket_index(units(data))];
+    ++m_samples;
+    m_sum += data;
+    m_min = std::min(m_min, data);
+    m_max = std::max(m_max, data);
+  }
+
+  void merge(const Histogram& other) {
+    if (!same_layout(other))
+      throw std::invalid_argument("histogram layouts differ");
+    for (auto i = size_t{ }; i < m_counts.size(); ++i)
+      m_counts[i] += other.m_counts[i];
+    m_samples += other.m_samples;
+    m_sum += other.m_sum;
+    m_min = std::min(m_min, other.m_min);
+    m_max = std::max(m_max, other.m_max);
+  }
+
+  // moves the recorded values to snapshot and resets the histogram,
+  // without allocating when snapshot has the same layout
+  void take_snapshot(Histogram& snapshot) {
+    if (same_layout(snapshot)) {
+      std::swap(m_counts, snapshot.m_counts);
+      snapshot.m_samples = m_samples;
+      snapshot.m_sum = m_sum;
+      snapshot.m_min = m_min;
+      snapshot.m_max = m_max;
+    }
+    else {
+      snapshot = *this;
+    }
+    reset();
+  }
+
+  void reset() {
+    std::fill(m_counts.begin(), m_counts.end(), uint64_t{ });
+    m_samples = 0;
+    m_sum = 0;
+    m_min = std::numeric_limits<double>::infinity();
+    m_max = -std::numeric_limits<double>::infinity();
+  }
+
+  uint64_t samples() const { return m_samples; }
+  size_t bucket_count() const { return m_counts.size(); }
+  T mean() const { return from_double<T>(m_samples ? m_sum / m_samples : 0.0); }
+  T min() const { return from_double<T>(m_samples ? m_min : 0.0); }
+  T max() const { return from_double<T>(m_samples ? m_max : 0.0); }
+
+  // returns the upper bound of the bucket containing the value, which is 
+  // greater or equal to percentile (0-100) percent of the samples
+  T percentile(double percentile) const {
+    if (!m_samples)
+      return T();
+    const auto rank = static_cast<uint64_t>(std::clamp(
+      std::ceil(percentile / 100.0 * static_cast<double>(m_samples)), 
+      1.0, static_cast<double>(m_samples)));
+    auto count = uint64_t{ };
+    for (auto i = size_t{ }; i < m_counts.size(); ++i) {
+      count += m_counts[i];
+      if (count >= rank)
+        return from_double<T>(std::clamp(
+          static_cast<double>(bucket_end(i)) * m_resolution, m_min, m_max));
+    }
+    return max();
+  }
+
+private:
+  bool same_layout(const Histogram& other) const {
+    return (m_resolution == other.m_resolution && 
+            m_precision_bits == other.m_precision_bits &&
+            m_counts.size() == other.m_counts.size());
+  }
+
+  uint64_t units(double value) const {
+    const auto units = value * m_units_per_value;
+    if (!(units > 0))
+      return 0;
+    return (units < static_cast<double>(m_max_units) ? 
+      static_cast<uint64_t>(units) : m_max_units);
+  }
+
+  // values below 2^(precision_bits + 1) have their own bucket, above each 
+  // doubling of the value is split into 2^precision_bits buckets
+  size_t bucket_index(uint64_t units) const {
+    if (units < (uint64_t{ 2 } << m_precision_bits))
+      return static_cast<size_t>(units);
+    const auto shift = detail::highest_bit(units) - m_precision_bits;
+    return (static_cast<size_t>(shift) << m_precision_bits) + 
+      static_cast<size_t>(units >> shift);
+  }
+
+  // first unit of the following bucket
+  uint64_t bucket_end(size_t index) const {
+    if (index < (size_t{ 2 } << m_precision_bits))
+      return index + 1;
+    const auto shift = static_cast<int>(index >> m_precision_bits) - 1;
+    const auto mantissa = index - (static_cast<size_t>(shift) << m_precision_bits);
+    return (static_cast<uint64_t>(mantissa) + 1) << shift;
+  }
+
+  double m_resolution;
+  double m_units_per_value;
+  int m_precision_bits;
+  uint64_t m_max_units{ };
+  std::vector<uint64_t> m_counts;
+  uint64_t m_samples{ };
+  double m_sum{ };
+  double m_min{ std::numeric_limits<double>::infinity() };
+  double m_max{ -std::numeric_limits<double>::infinity() };
+};
+
 template<typename It> // requires a sorted range
 auto median(It begin, It end) -> typename std::iterator_traits<It>::value_type {
   using Value = typename std::iterator_traits<It>::value_type;
@@ -11,6 +11,7 @@ private:
   double m_target_frame_rate{ };
   common::Duration m_last_present_time{ };
   common::ExponentialStatistic<common::Duration> m_frame_duration{ };
+  common::Duration m_last_frame_duration{ };
   common::Duration m_last_frame_time{ };
   int m_render_interval_counter{ };
   
@@ -23,6 +24,7 @@ private:
         m_frame_duration.reset(frame_duration);
       else
         m_frame_duration.push(frame_duration, 0.01);
+      m_last_frame_duration = frame_duration;
     }
     m_last_present_time = now;
   }
@@ -68,6 +70,11 @@ public:
     update_frame_duration();
     return update_render_interval();
   }
+
+  // duration between the last two updates, zero before the second update
+  common::Duration last_frame_duration() const {
+    return m_last_frame_duration;
+  }
 };
 
 } // namespace
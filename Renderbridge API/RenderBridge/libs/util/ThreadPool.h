@@ -0,0 +1,293 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace util {
+
+// executes jobs on worker threads, each owning a deque of jobs.
+// workers take their own jobs newest first and steal the oldest
+// jobs of others when they run out of work.
+class ThreadPool {
+public:
+  using Job = std::function<void()>;
+
+  explicit ThreadPool(size_t thread_count = std::thread::hardware_concurrency()) {
+    thread_count = std::max(thread_count, size_t{ 1 });
+    for (auto i = size_t{ }; i < thread_count; ++i)
+      m_queues.push_back(std::make_unique<Queue>());
+    for (auto i = size_t{ }; i < thread_count; ++i)
+      m_threads.emplace_back(&ThreadPool::thread_func, this, i);
+  }
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  // completes all submitted jobs before returning
+  ~ThreadPool() {
+    {
+      auto lock = std::lock_guard(m_mutex);
+      m_shutdown = true;
+    }
+    m_signal.notify_all();
+    for (auto& thread : m_threads)
+      thread.join();
+  }
+
+  size_t thread_count() const { return m_threads.size(); }
+
+  // jobs must not throw, jobs submitted by a worker go to its own deque
+  void submit(Job job) {
+    auto index = m_next_queue.fetch_add(1, std::memory_order_relaxed) % m_queues.size();
+    if (current_worker().pool == this)
+      index = current_worker().index;
+
+    auto& queue = *m_queues[index];
+    {
+      auto lock = std::lock_guard(queue.mutex);
+      queue.jobs.push_back(std::move(job));
+    }
+    {
+      auto lock = std::lock_guard(m_mutex);
+      ++m_pending;
+    }
+    m_signal.notify_one();
+  }
+
+  // executes one pending job on the calling thread, returns false when there was none.
+  // allows threads waiting for jobs to help instead of blocking workers.
+  bool run_pending_job() {
+    const auto& worker = current_worker();
+    auto job = Job();
+    if (!take_job((worker.pool == this ? worker.index : 0), job))
+      return false;
+    job();
+    return true;
+  }
+
+private:
+  struct alignas(64) Queue {
+    std::mutex mutex;
+    std::deque<Job> jobs;
+  };
+
+  struct Worker {
+    const ThreadPool* pool;
+    size_t index;
+  };
+
+  static Worker& current_worker() {
+    static thread_local auto worker = Worker{ };
+    return worker;
+  }
+
+  bool pop(size_t index, Job& job) {
+    auto& queue = *m_queues[index];
+    auto lock = std::lock_guard(queue.mutex);
+    if (queue.jobs.empty())
+      return false;
+    job = std::move(queue.jobs.back());
+    queue.jobs.pop_back();
+    return true;
+  }
+
+  bool steal(size_t index, Job& job) {
+    auto& queue = *m_queues[index];
+    auto lock = std::unique_lock(queue.mutex, std::try_to_lock);
+    if (!lock.owns_lock() || queue.jobs.empty())
+      return false;
+    job = std::move(queue.jobs.front());
+    queue.jobs.pop_front();
+    return true;
+  }
+
+  bool take_job(size_t index, Job& job) {
+    if (!m_pending.load(std::memory_order_acquire))
+      return false;
+
+    auto found = pop(index, job);
+    for (auto attempt = 0; !found && attempt < 2; ++attempt)
+      for (auto i = size_t{ 1 }; !found && i < m_queues.size(); ++i)
+        found = steal((index + i) % m_queues.size(), job);
+    if (!found)
+      return false;
+
+    auto lock = std::lock_guard(m_mutex);
+    --m_pending;
+    return true;
+  }
+
+  void thread_func(size_t index) {
+    current_worker() = { this, index };
+    auto job = Job();
+    for (;;) {
+      if (take_job(index, job)) {
+        job();
+        job = nullptr;
+        continue;
+      }
+      auto lock = std::unique_lock(m_mutex);
+      if (m_pending)
+        continue;
+      if (m_shutdown)
+        return;
+      m_signal.wait(lock);
+    }
+  }
+
+  std::vector<std::unique_ptr<Queue>> m_queues;
+  std::vector<std::thread> m_threads;
+  std::atomic<size_t> m_next_queue{ };
+  std::mutex m_mutex;
+  std::condition_variable m_signal;
+  std::atomic<size_t> m_pending{ };
+  bool m_shutdown{ };
+};
+
+// returns a pool shared by all devices and streams, which is created on
+// first use and destroyed when the last user releases it, so its threads
+// do not outlive the streams and are never joined while the module unloads
+inline std::shared_ptr<ThreadPool> get_shared_thread_pool() {
+  static auto mutex = std::mutex();
+  static auto shared = std::weak_ptr<ThreadPool>();
+  auto lock = std::lock_guard(mutex);
+  auto pool = shared.lock();
+  if (!pool) {
+    pool = std::make_shared<ThreadPool>();
+    shared = pool;
+  }
+  return pool;
+}
+
+// calls function(begin, end) for consecutive chunks of grain_size items of the
+// range and returns when all completed. the calling thread processes chunks too,
+// so it may be called from within a job. function must not throw.
+template<typename F>
+void parallel_for(ThreadPool& pool, size_t begin, size_t end, size_t grain_size, F&& function) {
+  if (begin >= end)
+    return;
+  grain_size = std::max(grain_size, size_t{ 1 });
+  const auto chunk_count = (end - begin + grain_size - 1) / grain_size;
+
+  auto next_chunk = std::atomic<size_t>{ };
+  auto helpers_done = std::atomic<size_t>{ };
+  const auto run_chunks = [&]() {
+    for (;;) {
+      const auto chunk = next_chunk.fetch_add(1, std::memory_order_relaxed);
+      if (chunk >= chunk_count)
+        return;
+      const auto chunk_begin = begin + chunk * grain_size;
+      function(chunk_begin, std::min(chunk_begin + grain_size, end));
+    }
+  };
+
+  const auto helpers = std::min(pool.thread_count(), chunk_count - 1);
+  for (auto i = size_t{ }; i < helpers; ++i)
+    pool.submit([&]() {
+      run_chunks();
+      helpers_done.fetch_add(1, std::memory_order_release);
+    });
+  run_chunks();
+
+  // helpers reference this frame, wait until all of them returned
+  while (helpers_done.load(std::memory_order_acquire) < helpers)
+    if (!pool.run_pending_job())
+      std::this_thread::yield();
+}
+
+// graph of jobs with dependencies, which can be run repeatedly,
+// for example once per frame with stages receive, convert, scale and hand off
+class TaskGraph {
+public:
+  using NodeId = size_t;
+
+  // dependencies have to be added before, which prevents cycles
+  NodeId add(std::function<void()> function, std::initializer_list<NodeId> dependencies = { }) {
+    const auto id = m_nodes.size();
+    for (auto dependency : dependencies)
+      if (dependency >= id)
+        throw std::out_of_range("invalid task dependency");
+
+    auto& node = m_nodes.emplace_back();
+    node.function = std::move(function);
+    node.dependency_count = dependencies.size();
+    for (auto dependency : dependencies)
+      m_nodes[dependency].successors.push_back(id);
+    return id;
+  }
+
+  size_t size() const { return m_nodes.size(); }
+
+  // executes each job after its dependencies completed, returns when all completed.
+  // the calling thread executes jobs too. jobs must not throw.
+  void run(ThreadPool& pool) {
+    if (m_nodes.empty())
+      return;
+    m_pool = &pool;
+    m_remaining.store(m_nodes.size(), std::memory_order_relaxed);
+    for (auto& node : m_nodes)
+      node.pending.store(node.dependency_count, std::memory_order_relaxed);
+
+    auto first_root = std::optional<NodeId>();
+    for (auto id = NodeId{ }; id < m_nodes.size(); ++id)
+      if (!m_nodes[id].dependency_count) {
+        if (!first_root)
+          first_root = id;
+        else
+          submit(id);
+      }
+    run_node(*first_root);
+
+    while (m_remaining.load(std::memory_order_acquire))
+      if (!pool.run_pending_job())
+        std::this_thread::yield();
+    m_pool = nullptr;
+  }
+
+private:
+  struct Node {
+    std::function<void()> function;
+    std::vector<NodeId> successors;
+    size_t dependency_count{ };
+    std::atomic<size_t> pending{ };
+  };
+
+  void submit(NodeId id) {
+    m_pool->submit([this, id]() { run_node(id); });
+  }
+
+  // continues with the last successor, which became ready, on the same thread
+  void run_node(NodeId id) {
+    for (;;) {
+      auto& node = m_nodes[id];
+      node.function();
+
+      auto next = std::optional<NodeId>();
+      for (auto successor : node.successors)
+        if (m_nodes[successor].pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+          if (next)
+            submit(*next);
+          next = successor;
+        }
+      m_remaining.fetch_sub(1, std::memory_order_release);
+      if (!next)
+        return;
+      id = *next;
+    }
+  }
+
+  std::deque<Node> m_nodes;
+  std::atomic<size_t> m_remaining{ };
+  ThreadPool* m_pool{ };
+};
+
+} // namespace